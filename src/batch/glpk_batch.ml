@@ -0,0 +1,95 @@
+(*
+ * ocaml-glpk - OCaml bindings to glpk
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *)
+
+(* The indices of the elements remaining to be processed by a worker, from lo
+   (included) to hi (excluded). The owner takes elements from the bottom and
+   thieves steal from the top. *)
+type range =
+  {
+    lock : Mutex.t;
+    mutable lo : int;
+    mutable hi : int;
+  }
+
+let map ?(domains = Domain.recommended_domain_count ()) f a =
+  let n = Array.length a in
+  let results = Array.make n (Error Not_found) in
+  let k = max 1 (min domains n) in
+  let ranges = Array.init k (fun w -> { lock = Mutex.create (); lo = w * n / k; hi = (w + 1) * n / k }) in
+  (* Take the next element of a worker, -1 if there is none. *)
+  let pop r =
+    Mutex.lock r.lock;
+    let i = if r.lo < r.hi then r.lo else -1 in
+      if i >= 0 then r.lo <- i + 1;
+      Mutex.unlock r.lock;
+      i
+  in
+  (* Steal half of the remaining elements of another worker. *)
+  let steal w =
+    let rec aux v =
+      if v = k then false
+      else
+        let r = ranges.((w + v) mod k) in
+          Mutex.lock r.lock;
+          let len = r.hi - r.lo in
+          let mid = r.hi - (len + 1) / 2 in
+          let hi = r.hi in
+            if len > 0 then r.hi <- mid;
+            Mutex.unlock r.lock;
+            if len > 0 then
+              (
+                let r = ranges.(w) in
+                  Mutex.lock r.lock;
+                  r.lo <- mid;
+                  r.hi <- hi;
+                  Mutex.unlock r.lock;
+                  true
+              )
+            else aux (v + 1)
+    in
+      aux 1
+  in
+  let rec work w =
+    let i = pop ranges.(w) in
+      if i >= 0 then
+        (
+          results.(i) <- (try Ok (f a.(i)) with e -> Error e);
+          work w
+        )
+      else if steal w then work w
+  in
+  let ds = List.init (k - 1) (fun w -> Domain.spawn (fun () -> work (w + 1))) in
+    work 0;
+    List.iter Domain.join ds;
+    results
+
+type outcome =
+  {
+    status : Glpk.status;
+    objective : float;
+  }
+
+let solve ?domains ?(solver = Glpk.simplex) builders =
+  map ?domains
+    (fun build ->
+       Glpk.with_problem (build ())
+         (fun lp ->
+            solver lp;
+            { status = Glpk.get_status lp; objective = Glpk.get_obj_val lp }))
+    builders
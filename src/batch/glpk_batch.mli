@@ -0,0 +1,35 @@
+(**
+  * Solving many independent problems in parallel.
+  *
+  * Problems are solved by a fixed pool of domains with work stealing: each
+  * domain starts with an equal share of the problems and, once done with its
+  * share, steals half of the remaining problems of another domain. Since the
+  * solving functions of {!Glpk} release the runtime lock, and each domain has
+  * its own runtime lock, both the construction and the solving of problems run
+  * in parallel. Because a glpk problem has to be used in the domain which
+  * created it, problems are described by functions building them, which are
+  * called by the workers. This requires OCaml 5.
+  *)
+
+(** [map ~domains f a] computes [f a.(i)] for every [i] using [domains] domains
+  * ([Domain.recommended_domain_count ()] by default), the calling domain being
+  * one of them. The results are returned in order, along with the exception
+  * raised by [f] when it failed. The results should not contain problems:
+  * problems belong to the domain which created them, and those created by
+  * the other domains are deleted when the domains terminate, before [map]
+  * returns. *)
+val map : ?domains:int -> ('a -> 'b) -> 'a array -> ('b, exn) result array
+
+(** Outcome of the solving of a problem. *)
+type outcome =
+  {
+    status : Glpk.status; (** status of the solution (see {!Glpk.get_status}) *)
+    objective : float; (** objective value of the solution *)
+  }
+
+(** [solve ~domains ~solver builders] builds the problems with the functions of
+  * [builders] and solves them with [solver] ([Glpk.simplex] by default) in
+  * parallel. It returns the status and objective value of each problem, or
+  * the exception raised when building or solving it. Each problem is deleted
+  * once solved, even if [solver] raises. *)
+val solve : ?domains:int -> ?solver:(Glpk.lp -> unit) -> (unit -> Glpk.lp) array -> (outcome, exn) result array
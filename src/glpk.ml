@@ -28,6 +28,110 @@ type prob_class = Linear_prog | Mixed_integer_prog
 
 type var_kind = Continuous_var | Integer_var
 
+type solution = Basic_solution | Mip_solution
+
+type solution_values = Col_primals | Col_duals | Row_primals | Row_duals
+
+type status = Undefined | Feasible | Infeasible | No_feasible | Optimal | Unbounded
+
+type mathprog_source = Mathprog_file of string | Mathprog_string of string
+
+type model_format = Cplex_lp_format | Fixed_mps_format | Free_mps_format
+
+type variables = Rows | Columns
+
+type quality = High_quality | Medium_quality | Low_quality | Bad_quality
+
+type kkt_check =
+  {
+    abs_error : float;
+    abs_error_index : int option;
+    rel_error : float;
+    rel_error_index : int option;
+    quality : quality;
+  }
+
+type kkt =
+  {
+    primal_equalities : kkt_check;
+    primal_bounds : kkt_check;
+    dual_equalities : kkt_check option;
+    dual_bounds : kkt_check option;
+  }
+
+type initial_basis = Standard_basis | Advanced_basis | Bixby_basis
+
+type cut = Cover_cuts | Clique_cuts | Gomory_cuts | Mir_cuts
+
+type msg_level = Msg_off | Msg_err | Msg_on | Msg_all
+
+type simplex_method = Primal_simplex | Dual_primal_simplex | Dual_simplex
+
+type pricing = Textbook_pricing | Steepest_edge_pricing
+
+type ratio_test = Textbook_ratio_test | Harris_ratio_test
+
+type simplex_params =
+  {
+    msg_level : msg_level;
+    meth : simplex_method;
+    pricing : pricing;
+    ratio_test : ratio_test;
+    primal_tolerance : float;
+    dual_tolerance : float;
+    pivot_tolerance : float;
+    obj_lower_limit : float;
+    obj_upper_limit : float;
+    iteration_limit : int;
+    time_limit : float;
+    output_frequency : int;
+    output_delay : float;
+    presolve : bool;
+  }
+
+type ordering = No_ordering | Quotient_minimum_degree | Approximate_minimum_degree | Symmetric_approximate_minimum_degree
+
+type interior_params =
+  {
+    ipt_msg_level : msg_level;
+    ordering : ordering;
+  }
+
+type branching = First_fractional_var | Last_fractional_var | Most_fractional_var | Driebeck_tomlin | Hybrid_pseudocost
+
+type backtracking = Depth_first | Breadth_first | Best_local_bound | Best_projection
+
+type preprocessing = No_preprocessing | Preprocess_root | Preprocess_all
+
+type mip_params =
+  {
+    mip_msg_level : msg_level;
+    branching : branching;
+    backtracking : backtracking;
+    preprocessing : preprocessing;
+    integer_tolerance : float;
+    objective_tolerance : float;
+    mip_gap : float;
+    mip_time_limit : float;
+    mip_output_frequency : float;
+    mip_output_delay : float;
+    mip_presolve : bool;
+    binarize : bool;
+    gomory_cuts : bool;
+    mir_cuts : bool;
+    cover_cuts : bool;
+    clique_cuts : bool;
+    feasibility_pump : bool;
+  }
+
+type int32_vector = (int32, Bigarray.int32_elt, Bigarray.c_layout) Bigarray.Array1.t
+
+type float_vector = (float, Bigarray.float64_elt, Bigarray.c_layout) Bigarray.Array1.t
+
+type float_matrix = (float, Bigarray.float64_elt, Bigarray.c_layout) Bigarray.Array2.t
+
+type byte_vector = (int, Bigarray.int8_unsigned_elt, Bigarray.c_layout) Bigarray.Array1.t
+
 exception Fault
 exception Lower_limit
 exception Upper_limit
@@ -40,6 +144,7 @@ exception Empty
 exception Bad_basis
 exception No_convergence
 exception Unknown_error
+exception Cancelled
 
 let _ =
   Callback.register_exception "ocaml_glpk_exn_fault" Fault;
@@ -53,10 +158,36 @@ let _ =
   Callback.register_exception "ocaml_glpk_exn_empty" Empty;
   Callback.register_exception "ocaml_glpk_exn_badb" Bad_basis;
   Callback.register_exception "ocaml_glpk_exn_noconv" No_convergence;
-  Callback.register_exception "ocaml_glpk_exn_unkown" Unknown_error;
+  Callback.register_exception "ocaml_glpk_exn_unknown" Unknown_error;
+  Callback.register_exception "ocaml_glpk_exn_cancelled" Cancelled;
+
+(* Register the custom operations of problems for unmarshaling. *)
+external init : unit -> unit = "ocaml_glpk_init"
+
+let _ = init ()
+
+external free_env : unit -> unit = "ocaml_glpk_free_env"
+
+let with_env f =
+  let ans = try f () with e -> free_env (); raise e in
+    free_env ();
+    ans
 
 external new_problem : unit -> lp = "ocaml_glpk_new_prob"
 
+external _copy_problem : lp -> bool -> lp = "ocaml_glpk_copy_prob"
+
+let copy_problem ?(names=true) lp = _copy_problem lp names
+
+external delete_problem : lp -> unit = "ocaml_glpk_delete_prob"
+
+let with_problem lp f =
+  let ans = try f lp with e -> delete_problem lp; raise e in
+    delete_problem lp;
+    ans
+
+external memory_usage : lp -> int = "ocaml_glpk_mem_usage"
+
 external set_prob_name : lp -> string -> unit = "ocaml_glpk_set_prob_name"
 
 external get_prob_name : lp -> string = "ocaml_glpk_get_prob_name"
@@ -91,8 +222,93 @@ external load_matrix : lp -> float array array -> unit = "ocaml_glpk_load_matrix
 
 external load_sparse_matrix : lp -> ((int * int) * float) array -> unit = "ocaml_glpk_load_sparse_matrix"
 
+external load_sparse_matrix_bigarray : lp -> int32_vector -> int32_vector -> float_vector -> unit = "ocaml_glpk_load_sparse_matrix_bigarray"
+
+external load_csr_matrix : lp -> int32_vector -> int32_vector -> float_vector -> unit = "ocaml_glpk_load_csr_matrix"
+
+external load_csc_matrix : lp -> int32_vector -> int32_vector -> float_vector -> unit = "ocaml_glpk_load_csc_matrix"
+
+external set_mat_row : lp -> int -> (int * float) array -> unit = "ocaml_glpk_set_mat_row"
+
+external set_mat_col : lp -> int -> (int * float) array -> unit = "ocaml_glpk_set_mat_col"
+
+external del_rows : lp -> int array -> unit = "ocaml_glpk_del_rows"
+
+external del_columns : lp -> int array -> unit = "ocaml_glpk_del_cols"
+
 external simplex : lp -> unit = "ocaml_glpk_simplex"
 
+external reoptimize : lp -> unit = "ocaml_glpk_reoptimize"
+
+external _solve_scenarios : lp -> float_matrix option * float_matrix option * float_matrix option * float_matrix option -> float_matrix option * float_matrix option -> float_vector -> unit = "ocaml_glpk_solve_scenarios"
+
+let solve_scenarios ?row_lower ?row_upper ?col_lower ?col_upper ?col_primals ?row_duals lp objectives =
+  _solve_scenarios lp (row_lower, row_upper, col_lower, col_upper) (col_primals, row_duals) objectives
+
+external _default_simplex_params : unit -> simplex_params = "ocaml_glpk_default_simplex_params"
+
+let default_simplex_params = _default_simplex_params ()
+
+external _default_interior_params : unit -> interior_params = "ocaml_glpk_default_interior_params"
+
+let default_interior_params = _default_interior_params ()
+
+external _default_mip_params : unit -> mip_params = "ocaml_glpk_default_mip_params"
+
+let default_mip_params = _default_mip_params ()
+
+type cancel_token
+
+external new_cancel_token : unit -> cancel_token = "ocaml_glpk_new_cancel_token"
+
+external cancel : cancel_token -> unit = "ocaml_glpk_cancel"
+
+external is_cancelled : cancel_token -> bool = "ocaml_glpk_is_cancelled"
+
+external _simplex_with_params : lp -> simplex_params -> cancel_token option -> initial_basis option -> unit = "ocaml_glpk_simplex_with_params"
+
+let simplex_with_params ?cancel ?basis lp params = _simplex_with_params lp params cancel basis
+
+external interior_with_params : lp -> interior_params -> unit = "ocaml_glpk_interior_with_params"
+
+type progress
+
+type progress_sample =
+  {
+    elapsed : float;
+    nodes : int;
+    active_nodes : int;
+    best_bound : float;
+    incumbent : float;
+    gap : float;
+  }
+
+external _new_progress : int -> float -> progress = "ocaml_glpk_new_progress"
+
+let new_progress ?(capacity=1024) ?(interval=0.1) () = _new_progress capacity interval
+
+external poll_progress : progress -> progress_sample array = "ocaml_glpk_poll_progress"
+
+external _branch_and_bound_with_params : lp -> mip_params -> cancel_token option -> progress option -> unit = "ocaml_glpk_branch_and_bound_with_params"
+
+let branch_and_bound_with_params ?cancel ?progress lp params = _branch_and_bound_with_params lp params cancel progress
+
+type log
+
+external _new_log : int -> log = "ocaml_glpk_new_log"
+
+let new_log ?(capacity=65536) () = _new_log capacity
+
+external read_log : log -> string = "ocaml_glpk_read_log"
+
+external set_log : log option -> log option = "ocaml_glpk_set_log"
+
+let with_log log f =
+  let prev = set_log (Some log) in
+  let ans = try f () with e -> ignore (set_log prev); raise e in
+    ignore (set_log prev);
+    ans
+
 external get_obj_val : lp -> float = "ocaml_glpk_get_obj_val"
 
 external get_col_primal : lp -> int -> float = "ocaml_glpk_get_col_prim"
@@ -130,15 +346,6 @@ external get_num_rows : lp -> int = "ocaml_glpk_get_num_rows"
 
 external get_num_cols : lp -> int = "ocaml_glpk_get_num_cols"
 
-let get_col_primals lp =
-  let n = get_num_cols lp in
-  let ans = Array.make n 0. in
-    for i = 0 to (n - 1)
-    do
-      ans.(i) <- get_col_primal lp i
-    done;
-    ans
-
 external scale_problem : lp -> unit = "ocaml_glpk_scale_problem"
 
 external unscale_problem : lp -> unit = "ocaml_glpk_unscale_problem"
@@ -149,20 +356,161 @@ external set_class : lp -> prob_class -> unit = "ocaml_glpk_set_class"
 
 external get_class : lp -> prob_class = "ocaml_glpk_get_class"
 
+let default_solution lp what = function
+  | Some sol -> sol
+  | None ->
+    match what with
+      | Col_primals | Row_primals when get_class lp = Mixed_integer_prog -> Mip_solution
+      | _ -> Basic_solution
+
+external _get_values : lp -> solution -> solution_values -> float array -> unit = "ocaml_glpk_get_values"
+
+let get_values ?solution lp what a =
+  _get_values lp (default_solution lp what solution) what a
+
+external _get_values_bigarray : lp -> solution -> solution_values -> float_vector -> unit = "ocaml_glpk_get_values_bigarray"
+
+let get_values_bigarray ?solution lp what a =
+  _get_values_bigarray lp (default_solution lp what solution) what a
+
+external _get_status : lp -> solution -> status = "ocaml_glpk_get_status"
+
+let get_status ?solution lp = _get_status lp (default_solution lp Col_primals solution)
+
+external _check_kkt : lp -> solution -> kkt = "ocaml_glpk_check_kkt"
+
+let check_kkt ?solution lp =
+  let solution =
+    match solution with
+      | Some sol -> sol
+      | None -> if get_class lp = Mixed_integer_prog then Mip_solution else Basic_solution
+  in
+    _check_kkt lp solution
+
+external get_basis : lp -> byte_vector -> byte_vector -> unit = "ocaml_glpk_get_basis"
+
+external set_basis : lp -> byte_vector -> byte_vector -> unit = "ocaml_glpk_set_basis"
+
+external _bound_ranges : lp -> int -> bool -> float_vector -> float_vector -> unit = "ocaml_glpk_bound_ranges"
+
+let bound_ranges ?(first=0) lp cols lo hi = _bound_ranges lp first (cols = Columns) lo hi
+
+external _cost_ranges : lp -> int -> bool -> float_vector -> float_vector -> unit = "ocaml_glpk_cost_ranges"
+
+let cost_ranges ?(first=0) lp cols lo hi = _cost_ranges lp first (cols = Columns) lo hi
+
+let get_all_values ?solution lp what =
+  let n =
+    match what with
+      | Col_primals | Col_duals -> get_num_cols lp
+      | Row_primals | Row_duals -> get_num_rows lp
+  in
+  let ans = Array.make n 0. in
+    get_values ?solution lp what ans;
+    ans
+
+let get_col_primals ?solution lp = get_all_values ?solution lp Col_primals
+
+let get_col_duals ?solution lp = get_all_values ?solution lp Col_duals
+
+let get_row_primals ?solution lp = get_all_values ?solution lp Row_primals
+
+let get_row_duals ?solution lp = get_all_values ?solution lp Row_duals
+
 external set_col_kind : lp -> int -> var_kind -> unit = "ocaml_glpk_set_col_kind"
 
 external branch_and_bound : lp -> unit = "ocaml_glpk_integer"
 
-external branch_and_bound_opt : lp -> unit = "ocaml_glpk_integer"
+external branch_and_bound_opt : lp -> unit = "ocaml_glpk_intopt"
 
 external warm_up : lp -> unit = "ocaml_glpk_warm_up"
 
+external build_basis : lp -> initial_basis -> unit = "ocaml_glpk_build_basis"
+
+external eval_tab_row : lp -> int -> int32_vector -> float_vector -> int = "ocaml_glpk_eval_tab_row"
+
+external eval_tab_col : lp -> int -> int32_vector -> float_vector -> int = "ocaml_glpk_eval_tab_col"
+
+external transform_row : lp -> int -> int32_vector -> float_vector -> int = "ocaml_glpk_transform_row"
+
+external transform_col : lp -> int -> int32_vector -> float_vector -> int = "ocaml_glpk_transform_col"
+
+external prim_ratio_test : lp -> int -> int32_vector -> float_vector -> bool -> float -> int option = "ocaml_glpk_prim_ratio_test_bytecode" "ocaml_glpk_prim_ratio_test"
+
+external dual_ratio_test : lp -> int -> int32_vector -> float_vector -> bool -> float -> int option = "ocaml_glpk_dual_ratio_test_bytecode" "ocaml_glpk_dual_ratio_test"
+
+external ftran : lp -> float_vector -> unit = "ocaml_glpk_ftran"
+
+external btran : lp -> float_vector -> unit = "ocaml_glpk_btran"
+
 external use_presolver : lp -> bool -> unit = "ocaml_glpk_set_use_presolver"
 
+external use_dual_simplex : lp -> bool -> unit = "ocaml_glpk_set_use_dual_simplex"
+
+external use_binarization : lp -> bool -> unit = "ocaml_glpk_set_binarization"
+
+let cut_flag = function
+  | Cover_cuts -> 0x01
+  | Clique_cuts -> 0x02
+  | Gomory_cuts -> 0x04
+  | Mir_cuts -> 0x08
+
+external _set_cuts : lp -> int -> unit = "ocaml_glpk_set_cuts"
+
+let set_cuts lp cuts =
+  _set_cuts lp (List.fold_left (fun flags c -> flags lor cut_flag c) 0 cuts)
+
+external _get_cuts : lp -> int = "ocaml_glpk_get_cuts"
+
+let get_cuts lp =
+  let flags = _get_cuts lp in
+    List.filter (fun c -> flags land cut_flag c <> 0) [Cover_cuts; Clique_cuts; Gomory_cuts; Mir_cuts]
+
+external _set_mip_gap : lp -> float -> unit = "ocaml_glpk_set_mip_gap"
+
+let set_mip_gap lp gap =
+  if gap < 0. then
+    raise (Invalid_argument "set_mip_gap");
+  _set_mip_gap lp gap
+
+external get_mip_gap : lp -> float = "ocaml_glpk_get_mip_gap"
+
 external read_cplex : string -> lp = "ocaml_glpk_read_cplex"
 
 external write_cplex : lp -> string -> unit = "ocaml_glpk_write_cplex"
 
+external _read_mps : bool -> string -> lp = "ocaml_glpk_read_mps"
+
+let read_mps ?(free=false) fname = _read_mps free fname
+
+external _write_mps : bool -> lp -> string -> unit = "ocaml_glpk_write_mps"
+
+let write_mps ?(free=false) lp fname = _write_mps free lp fname
+
+external read_string : model_format -> string -> lp = "ocaml_glpk_read_string"
+
+external read_bigarray : model_format -> byte_vector -> lp = "ocaml_glpk_read_bigarray"
+
+external write_string : model_format -> lp -> string = "ocaml_glpk_write_string"
+
+type mathprog_model
+
+external mathprog_model : mathprog_source -> mathprog_model = "ocaml_glpk_mathprog_model"
+
+external _build_mathprog : mathprog_model -> mathprog_source list -> lp = "ocaml_glpk_mathprog_build"
+
+let build_mathprog ?(data=[]) model = _build_mathprog model data
+
+external _save_binary : bool -> lp -> string -> unit = "ocaml_glpk_save_binary"
+
+let save_binary ?(names=true) lp fname = _save_binary names lp fname
+
+external load_binary : string -> lp = "ocaml_glpk_load_binary"
+
+external read_basis : lp -> string -> unit = "ocaml_glpk_read_basis"
+
+external write_basis : lp -> string -> unit = "ocaml_glpk_write_basis"
+
 external set_simplex_iteration_count : lp -> int -> unit = "ocaml_glpk_set_iteration_count"
 
 let reset_simplex_iteration_count lp =
@@ -10,7 +10,11 @@
 
 (** {1 Types} *) (* TODO: better comment! *)
 
-(** A linear programmation problem. *)
+(** A linear programmation problem. Problems can be marshaled (with [Marshal])
+  * in a compact binary form, which includes the constraint matrix, bounds,
+  * objective, kinds of variables, names, control parameters, scaling and the
+  * current basis, but not the solutions. A deleted problem (see
+  * [delete_problem]) is unmarshaled as a deleted problem. *)
 type lp
 
 (** Direction of the optimization. *)
@@ -29,6 +33,193 @@ type var_kind =
   | Continuous_var (** continuous variable *)
   | Integer_var (** integer variable *)
 
+(** Solution of a problem. *)
+type solution =
+  | Basic_solution (** basic solution, computed by [simplex] *)
+  | Mip_solution (** integer solution, computed by [branch_and_bound] *)
+
+(** Values of a solution which can be retrieved at once. *)
+type solution_values =
+  | Col_primals (** primal values of the columns *)
+  | Col_duals (** dual values (reduced costs) of the columns *)
+  | Row_primals (** primal values of the rows *)
+  | Row_duals (** dual values of the rows *)
+
+(** Status of a solution. *)
+type status =
+  | Undefined (** the solution is undefined (e.g. the problem was not solved) *)
+  | Feasible (** the solution is feasible *)
+  | Infeasible (** the solution is infeasible *)
+  | No_feasible (** the problem has no feasible solution *)
+  | Optimal (** the solution is optimal *)
+  | Unbounded (** the problem has an unbounded solution *)
+
+(** Source of a MathProg model or data set: a file name or the text itself. *)
+type mathprog_source = Mathprog_file of string | Mathprog_string of string
+
+(** Formats of problem data. *)
+type model_format =
+  | Cplex_lp_format (** CPLEX LP format *)
+  | Fixed_mps_format (** fixed MPS format *)
+  | Free_mps_format (** free MPS format *)
+
+(** Variables associated with rows (auxiliary variables) or columns (structural
+  * variables). *)
+type variables = Rows | Columns
+
+(** Quality of a solution with respect to a condition. *)
+type quality =
+  | High_quality (** relative error at most 1e-9 *)
+  | Medium_quality (** relative error at most 1e-6 *)
+  | Low_quality (** relative error at most 1e-3 *)
+  | Bad_quality (** the condition is not satisfied *)
+
+(** Errors of a solution with respect to a condition. *)
+type kkt_check =
+  {
+    abs_error : float; (** largest absolute error *)
+    abs_error_index : int option; (** where the largest absolute error is reached *)
+    rel_error : float; (** largest relative error *)
+    rel_error_index : int option; (** where the largest relative error is reached *)
+    quality : quality; (** quality deduced from the relative error *)
+  }
+
+(** Karush-Kuhn-Tucker optimality conditions of a solution. *)
+type kkt =
+  {
+    primal_equalities : kkt_check; (** rows are equal to the combinations of columns (indexes are rows) *)
+    primal_bounds : kkt_check; (** variables are within their bounds (indexes are variables, rows coming first) *)
+    dual_equalities : kkt_check option; (** reduced costs are consistent (indexes are columns), [None] for MIP solutions *)
+    dual_bounds : kkt_check option; (** reduced costs have the right signs (indexes are variables), [None] for MIP solutions *)
+  }
+
+(** Strategies to construct an initial basis. *)
+type initial_basis =
+  | Standard_basis (** all auxiliary variables basic *)
+  | Advanced_basis (** basis trying to be as much triangular as possible *)
+  | Bixby_basis (** Bixby's crash basis *)
+
+(** Cutting planes generated by the branch-and-cut solver. *)
+type cut =
+  | Cover_cuts (** mixed cover cuts *)
+  | Clique_cuts (** clique cuts *)
+  | Gomory_cuts (** Gomory's mixed integer cuts *)
+  | Mir_cuts (** mixed integer rounding cuts *)
+
+(** Level of messages output by the solvers. *)
+type msg_level =
+  | Msg_off (** no output *)
+  | Msg_err (** error and warning messages only *)
+  | Msg_on (** normal output *)
+  | Msg_all (** full output (includes informational messages) *)
+
+(** Simplex method. *)
+type simplex_method =
+  | Primal_simplex (** primal simplex *)
+  | Dual_primal_simplex (** dual simplex, switching to the primal simplex if it fails *)
+  | Dual_simplex (** dual simplex *)
+
+(** Pricing technique. *)
+type pricing =
+  | Textbook_pricing (** standard (textbook) pricing *)
+  | Steepest_edge_pricing (** projected steepest edge *)
+
+(** Ratio test technique. *)
+type ratio_test =
+  | Textbook_ratio_test (** standard (textbook) ratio test *)
+  | Harris_ratio_test (** Harris' two-pass ratio test *)
+
+(** Parameters of the simplex solver (see [glp_smcp] in glpk's documentation).
+  * Limits are given in seconds and may be [infinity] (or [max_int] for the
+  * iteration limit). *)
+type simplex_params =
+  {
+    msg_level : msg_level;
+    meth : simplex_method;
+    pricing : pricing;
+    ratio_test : ratio_test;
+    primal_tolerance : float; (** tolerance used to check primal feasibility *)
+    dual_tolerance : float; (** tolerance used to check dual feasibility *)
+    pivot_tolerance : float; (** tolerance used to choose pivotal elements *)
+    obj_lower_limit : float; (** lower limit of the objective (dual simplex only) *)
+    obj_upper_limit : float; (** upper limit of the objective (dual simplex only) *)
+    iteration_limit : int;
+    time_limit : float; (** in seconds *)
+    output_frequency : int; (** in iterations *)
+    output_delay : float; (** in seconds *)
+    presolve : bool; (** use the LP presolver *)
+  }
+
+(** Ordering algorithm used by the interior point method. *)
+type ordering =
+  | No_ordering (** natural (original) ordering *)
+  | Quotient_minimum_degree (** quotient minimum degree *)
+  | Approximate_minimum_degree (** approximate minimum degree *)
+  | Symmetric_approximate_minimum_degree (** approximate minimum degree for symmetric matrices *)
+
+(** Parameters of the interior point solver (see [glp_iptcp]). *)
+type interior_params =
+  {
+    ipt_msg_level : msg_level;
+    ordering : ordering;
+  }
+
+(** Branching technique. *)
+type branching =
+  | First_fractional_var (** first fractional variable *)
+  | Last_fractional_var (** last fractional variable *)
+  | Most_fractional_var (** most fractional variable *)
+  | Driebeck_tomlin (** heuristic by Driebeck and Tomlin *)
+  | Hybrid_pseudocost (** hybrid pseudocost heuristic *)
+
+(** Backtracking technique. *)
+type backtracking =
+  | Depth_first (** depth first search *)
+  | Breadth_first (** breadth first search *)
+  | Best_local_bound (** best local bound *)
+  | Best_projection (** best projection heuristic *)
+
+(** Preprocessing technique. *)
+type preprocessing =
+  | No_preprocessing (** disable preprocessing *)
+  | Preprocess_root (** preprocessing only on the root level *)
+  | Preprocess_all (** preprocessing on all levels *)
+
+(** Parameters of the branch-and-cut solver (see [glp_iocp]). Times are given
+  * in seconds and may be [infinity]. *)
+type mip_params =
+  {
+    mip_msg_level : msg_level;
+    branching : branching;
+    backtracking : backtracking;
+    preprocessing : preprocessing;
+    integer_tolerance : float; (** tolerance used to check integer feasibility *)
+    objective_tolerance : float; (** tolerance used to compare objective values *)
+    mip_gap : float; (** relative mip gap tolerance *)
+    mip_time_limit : float; (** in seconds *)
+    mip_output_frequency : float; (** in seconds, unlike [output_frequency] *)
+    mip_output_delay : float; (** in seconds *)
+    mip_presolve : bool; (** use the MIP presolver *)
+    binarize : bool; (** replace integer variables by binary ones *)
+    gomory_cuts : bool; (** generate Gomory's mixed integer cuts *)
+    mir_cuts : bool; (** generate mixed integer rounding cuts *)
+    cover_cuts : bool; (** generate mixed cover cuts *)
+    clique_cuts : bool; (** generate clique cuts *)
+    feasibility_pump : bool; (** use the feasibility pump heuristic *)
+  }
+
+(** Vectors of indexes, used to pass large amounts of data without copying. *)
+type int32_vector = (int32, Bigarray.int32_elt, Bigarray.c_layout) Bigarray.Array1.t
+
+(** Vectors of floats, used to pass large amounts of data without copying. *)
+type float_vector = (float, Bigarray.float64_elt, Bigarray.c_layout) Bigarray.Array1.t
+
+(** Matrices of floats. *)
+type float_matrix = (float, Bigarray.float64_elt, Bigarray.c_layout) Bigarray.Array2.t
+
+(** Vectors of bytes. *)
+type byte_vector = (int, Bigarray.int8_unsigned_elt, Bigarray.c_layout) Bigarray.Array1.t
+
 (** {1 Exceptions} *)
 
 (** The problem has no rows/columns, or the initial basis is invalid, or the initial basis matrix is singular or ill-conditionned. *)
@@ -67,14 +258,60 @@ exception Solver_failure
 (** Unknown error (this exception should disappear in future versions). *)
 exception Unknown_error
 
+(** The solving was cancelled (see [cancel]). *)
+exception Cancelled
+
 
 (** {1 Functions} *)
 
+(** {2 Threads}
+
+  Problems can be solved concurrently in several threads (or domains), the
+  solving functions release the runtime lock. However, glpk keeps its memory in
+  a per-thread environment, so a problem should only be used in the thread
+  where it was created (problems finalized in another thread are freed by the
+  creating thread later on). The environment of a thread is freed when the
+  thread terminates, together with the problems it created: the problems
+  returned by a thread cannot be used once it has terminated. *)
+
+(** Free the glpk environment of the current thread, including all the problems
+  * created by this thread. Functions taking one of those problems as argument
+  * raise [Invalid_argument] afterwards. *)
+val free_env : unit -> unit
+
+(** [with_env f] runs [f ()] and then frees the glpk environment of the current
+  * thread. *)
+val with_env : (unit -> 'a) -> 'a
+
 (** {2 Creating, reading and saving problems} *)
 
 (** Create a new linear programmation problem. *)
 val new_problem : unit -> lp
 
+(** Create a copy of a problem, including its control parameters as well as its
+  * current basis and solutions, so that solving the copy after modifications
+  * starts from this basis. Symbolic names are copied unless [names] is
+  * [false]. *)
+val copy_problem : ?names:bool -> lp -> lp
+
+(** Free the memory used by a problem without waiting for it to be collected.
+  * The problem cannot be used afterwards: functions taking it as argument
+  * raise [Invalid_argument]. Deleting a problem twice has no effect. Deleting a
+  * problem while another thread is using it, for instance while solving it, is
+  * not checked: the other thread then accesses freed memory, which is likely to
+  * crash the program. *)
+val delete_problem : lp -> unit
+
+(** [with_problem lp f] computes [f lp] and deletes [lp] afterwards, even if
+  * [f] raises an exception. *)
+val with_problem : lp -> (lp -> 'a) -> 'a
+
+(** Estimated memory used by a problem, in bytes, as reported to the garbage
+  * collector. This is the largest estimated size of the problem, since it
+  * was created.
+  * @raise Invalid_argument if the problem has been deleted. *)
+val memory_usage : lp -> int
+
 (** [make_problem dir zcoefs constrs pbounds xbounds] creates the new linear programmation problem where Z = Sum_i [zcoefs.(i)] * x_ i should be optimized in the direction [dir] under the constraints [fst pbounds.(i)] <= p_i <= [snd pbounds.(i)] and [fst xbounds.(i)] <= x_i <= [snd xbounds.(i)] where p_i = Sum_j [constrs.(i).(j)] * x_j. The bounds may be [+] / [- infinity]. *)
 val make_problem : direction -> float array -> float array array -> (float * float) array -> (float * float) array -> lp
 
@@ -84,6 +321,75 @@ val read_cplex : string -> lp
 (** Write prblem data in CPLEX LP format into a file. *)
 val write_cplex : lp -> string -> unit
 
+(** Read problem data in MPS format from a file, in free MPS format if [free] is
+  * [true] and in fixed MPS format otherwise (default). Files whose name ends
+  * with [.gz] are decompressed on the fly by glpk. *)
+val read_mps : ?free:bool -> string -> lp
+
+(** Write problem data in MPS format into a file, in free MPS format if [free]
+  * is [true] and in fixed MPS format otherwise (default). Files whose name ends
+  * with [.gz] are compressed by glpk. *)
+val write_mps : ?free:bool -> lp -> string -> unit
+
+(** Read problem data in the given format from a string. The runtime lock is
+  * released during the parsing. No file is created: glpk reads the data
+  * through a pipe, so that this is only available on systems providing
+  * [/dev/fd]. *)
+val read_string : model_format -> string -> lp
+
+(** Same as [read_string] but reads the data from a bigarray, which is not
+  * copied. *)
+val read_bigarray : model_format -> byte_vector -> lp
+
+(** Write problem data in the given format into a string. As for
+  * [read_string], the data goes through a pipe and the runtime lock is
+  * released. *)
+val write_string : model_format -> lp -> string
+
+(** A MathProg (GMPL) model. *)
+type mathprog_model
+
+(** Create a MathProg model from its source, which is only kept in order to be
+  * used with several data sets: the model is neither read nor checked here,
+  * errors being reported by [build_mathprog]. A model given as a file name is
+  * read again from the file by each build. *)
+val mathprog_model : mathprog_source -> mathprog_model
+
+(** Translate a MathProg model with the given data sets into a problem. If
+  * [data] is not empty, the data section of the model is ignored. The runtime
+  * lock is released during the translation, and a model can be used from
+  * several threads at once. Since glpk can neither reuse nor copy a
+  * translator, the whole model is parsed again for each call: the cost of a
+  * build is the cost of a full translation, and using a model several times
+  * saves nothing compared to translating its source each time.
+  * Models given as text are read through a pipe, as in [read_string].
+  * @raise Failure if the translation fails, glpk printing the error. *)
+val build_mathprog : ?data:mathprog_source list -> mathprog_model -> lp
+
+(** Save problem data into a file in a binary format, much faster to load than
+  * textual formats: it consists of a header followed by the arrays of the
+  * constraint matrix in compressed sparse column form, bounds, objective and
+  * kinds of variables and, if [names] is [true] (default), the names. The
+  * control parameters and the basis are not saved. The file uses the byte order
+  * of the machine. *)
+val save_binary : ?names:bool -> lp -> string -> unit
+
+(** Load problem data saved by [save_binary]. The file is mapped in memory and
+  * the runtime lock is released during the loading.
+  * @raise Failure if the file is not valid. *)
+val load_binary : string -> lp
+
+(** Read a basis in MPS format from a file (see [write_basis]) and install it in
+  * the problem. Rows and columns are designated by their names, or by [R]i and
+  * [C]j (with 1-based indexes) when they have none. The basis of the problem is
+  * left unchanged if the file is not valid. Unlike [read_mps], compressed files
+  * are not supported.
+  * @raise Failure if the file cannot be read or is not valid. *)
+val read_basis : lp -> string -> unit
+
+(** Write the current basis in MPS format into a file. *)
+val write_basis : lp -> string -> unit
+
 
 (** {2 Setting and retreiving paramters of a problem} *)
 
@@ -154,6 +460,50 @@ val load_matrix : lp -> float array array -> unit
   * form ((row, column), value) indicating non-null elements of the matrix. *)
 val load_sparse_matrix : lp -> ((int * int) * float) array -> unit
 
+(** [load_sparse_matrix_bigarray lp rows cols vals] loads a sparse constraint
+  * matrix whose k-th non-null element is [vals.{k}] at row [rows.{k}] and
+  * column [cols.{k}]. The values are handed to glpk without being copied,
+  * and the indexes are copied once in order to make them 1-based; the vectors
+  * are not modified and can be shared between threads.
+  * @raise Invalid_argument if the vectors do not have the same length, an
+  * index is out of bounds or an element is given twice. *)
+val load_sparse_matrix_bigarray : lp -> int32_vector -> int32_vector -> float_vector -> unit
+
+(** [load_csr_matrix lp ptr cols vals] loads a constraint matrix in compressed
+  * sparse row format: the non-null elements of row [i] are [vals.{k}] at column
+  * [cols.{k}] for [ptr.{i}] <= k < [ptr.{i+1}]. The vector [ptr] should thus
+  * have one more element than the number of rows. As for
+  * [load_sparse_matrix_bigarray], the values are not copied and the vectors
+  * are not modified.
+  * @raise Invalid_argument if the vectors are not consistent or a column is
+  * repeated within a row, in which case the matrix is left unchanged. *)
+val load_csr_matrix : lp -> int32_vector -> int32_vector -> float_vector -> unit
+
+(** Same as [load_csr_matrix] but in compressed sparse column format: [ptr] is
+  * indexed by columns and the second vector contains row indexes. *)
+val load_csc_matrix : lp -> int32_vector -> int32_vector -> float_vector -> unit
+
+(** [set_mat_row lp i row] replaces the [i]-th row of the constraint matrix by
+  * the elements of [row], given as (column, value) pairs. The current basis is
+  * kept (see [reoptimize]).
+  * @raise Invalid_argument if an index is out of bounds or repeated. *)
+val set_mat_row : lp -> int -> (int * float) array -> unit
+
+(** Same as [set_mat_row] for a column, given as (row, value) pairs.
+  * @raise Invalid_argument if an index is out of bounds or repeated. *)
+val set_mat_col : lp -> int -> (int * float) array -> unit
+
+(** Delete rows. The remaining rows are renumbered. The basis stays valid if the
+  * auxiliary variables of the deleted rows are basic, which is the case of
+  * inactive constraints after [simplex].
+  * @raise Invalid_argument if an index is out of bounds or repeated. *)
+val del_rows : lp -> int array -> unit
+
+(** Delete columns. The basis stays valid if the deleted columns are
+  * non-basic.
+  * @raise Invalid_argument if an index is out of bounds or repeated. *)
+val del_columns : lp -> int array -> unit
+
 
 (** {2 Solving problems and retreiving solutions} *)
 
@@ -166,36 +516,303 @@ val unscale_problem : lp -> unit
 (** Warm up the LP basis for the specified problem object using current statuses assigned to rows and columns. *)
 val warm_up : lp -> unit
 
+(** Replace the current basis by an initial one constructed according to the
+  * given strategy. [Advanced_basis] or [Bixby_basis] usually reduce the time
+  * spent by the simplex to find a feasible solution. *)
+val build_basis : lp -> initial_basis -> unit
+
 (** Solve an LP problem using the simplex method. You must use builtin presolver
   * (see [use_presolver]) to get an exception if the problem has no feasible
   * solution. *)
 val simplex : lp -> unit
 
+(** Solve an LP problem again after modifications using the dual simplex,
+  * starting from the current basis (which is usually still dual feasible after
+  * adding rows or changing bounds) and without the presolver. If the basis got
+  * invalid, for instance because of row deletions, an advanced initial basis is
+  * used instead. *)
+val reoptimize : lp -> unit
+
+(** [solve_scenarios lp objectives] solves an LP problem for several sets of
+  * bounds (scenarios) and stores the optimal value of the [s]-th scenario in
+  * [objectives.{s}]. The bounds of scenario [s] are given by the [s]-th rows
+  * of the matrices [row_lower], [row_upper], [col_lower] and [col_upper]
+  * (whose numbers of columns are the numbers of rows or columns of the
+  * problem), infinite values meaning no bound; the current bounds are used for
+  * the omitted ones. The primal values of the columns and the dual values of
+  * the rows are similarly stored in [col_primals] and [row_duals] when given.
+  * Each scenario is solved by the dual simplex starting from the basis of the
+  * previous one and the values of scenarios without optimal solution are
+  * [nan]. The runtime lock is released during the whole computation and the
+  * original bounds are restored at the end.
+  * @raise Invalid_argument if a matrix does not have the right dimensions. *)
+val solve_scenarios : ?row_lower:float_matrix -> ?row_upper:float_matrix -> ?col_lower:float_matrix -> ?col_upper:float_matrix -> ?col_primals:float_matrix -> ?row_duals:float_matrix -> lp -> float_vector -> unit
+
 (** Solve an LP problem using the primal-dual interior point method. *)
 val interior : lp -> unit
 
 (** Solve a MIP proble using the branch-and-bound method. *)
 val branch_and_bound : lp -> unit
 
-(** Solve a MIP proble using and optimized version of the branch-and-bound method. *)
+(** Solve a MIP problem using the branch-and-cut method with the MIP presolver,
+  * which is generally much faster than [branch_and_bound]. Contrarily to
+  * [branch_and_bound], the problem does not need to be solved by [simplex]
+  * beforehand. See also [set_cuts], [use_binarization] and [set_mip_gap]. *)
 val branch_and_bound_opt : lp -> unit
 
+(** A cancellation token, used to stop a running solver from another thread. *)
+type cancel_token
+
+(** Create a new cancellation token. *)
+val new_cancel_token : unit -> cancel_token
+
+(** Request the cancellation of the solvers using the token. This can be called
+  * from any thread, solvers raise [Cancelled] shortly after. A token cannot be
+  * reset. *)
+val cancel : cancel_token -> unit
+
+(** Has the cancellation been requested? *)
+val is_cancelled : cancel_token -> bool
+
+(** Default parameters of the simplex solver. *)
+val default_simplex_params : simplex_params
+
+(** Solve an LP problem using the simplex method with given parameters. The
+  * control parameters of the problem are not used. When [cancel] is given, the
+  * token is checked every 0.1 to 2 seconds and the simplex is stopped, with the
+  * current basis kept, by raising [Cancelled]; when the LP presolver is used,
+  * it is only checked before starting. Checking the token has a cost: the
+  * simplex is restarted after each check, which refactorizes the basis, loses
+  * the pricing weights of the steepest edge and prints the header of the
+  * output again. When [basis] is given, the simplex
+  * starts from a basis constructed with this strategy (see [build_basis])
+  * instead of the current one; this is useless with the LP presolver, which
+  * constructs its own basis. *)
+val simplex_with_params : ?cancel:cancel_token -> ?basis:initial_basis -> lp -> simplex_params -> unit
+
+(** Default parameters of the interior point solver. *)
+val default_interior_params : interior_params
+
+(** Solve an LP problem using the interior point method with given parameters. *)
+val interior_with_params : lp -> interior_params -> unit
+
+(** Progress feed of the branch-and-cut solver. *)
+type progress
+
+(** A snapshot of the branch-and-cut search. *)
+type progress_sample =
+  {
+    elapsed : float; (** time since the beginning of the search, in seconds *)
+    nodes : int; (** number of nodes generated so far *)
+    active_nodes : int; (** number of active nodes *)
+    best_bound : float; (** best bound over active nodes *)
+    incumbent : float; (** objective of the best integer solution, [nan] if none was found yet *)
+    gap : float; (** relative gap between [best_bound] and [incumbent], [infinity] if no integer solution was found yet *)
+  }
+
+(** Create a progress feed keeping up to [capacity] samples (default: [1024]).
+  * A sample is recorded each time a better integer solution is found and,
+  * otherwise, at most every [interval] seconds (default: [0.1]). *)
+val new_progress : ?capacity:int -> ?interval:float -> unit -> progress
+
+(** Retrieve the samples recorded since the last call, oldest first. This can
+  * be called from another thread while the solver is running. If more than
+  * [capacity] samples were recorded in between, only the latest ones are
+  * returned. A progress feed must only be polled by one thread at a time. *)
+val poll_progress : progress -> progress_sample array
+
+(** Default parameters of the branch-and-cut solver. *)
+val default_mip_params : mip_params
+
+(** Solve a MIP problem using the branch-and-cut method with given parameters.
+  * Unless the MIP presolver is used, the problem should have an optimal basic
+  * solution (see [simplex]). When [cancel] is given, the search is stopped by
+  * raising [Cancelled] soon after the token is cancelled, the best integer
+  * solution found so far being kept. When [progress] is given, samples of the
+  * search are recorded in it (see [poll_progress]); together with [cancel],
+  * this can be used to stop the search once the gap is small enough. *)
+val branch_and_bound_with_params : ?cancel:cancel_token -> ?progress:progress -> lp -> mip_params -> unit
+
+(** A buffer capturing the output of the solvers. *)
+type log
+
+(** Create a log keeping the last [capacity] bytes of output (default:
+  * [65536]). When the buffer is full, the oldest output is overwritten. *)
+val new_log : ?capacity:int -> unit -> log
+
+(** Get the output captured since the previous call. This can be called from
+  * another thread while a solver is running in order to stream its output.
+  * Output which was overwritten before being read is lost. A log must only be
+  * read by one thread at a time. *)
+val read_log : log -> string
+
+(** [with_log log f] runs [f ()] with the output of the solvers captured in
+  * [log] instead of being printed. The log is installed for the current thread
+  * rather than for a given solve: everything glpk prints in this thread while
+  * [f] runs is captured, including the output of several solves or of
+  * readers, and nothing printed by other threads, so that solvers running
+  * concurrently in other threads can use their own logs. Calls can be nested:
+  * the previous log is restored afterwards. The log is uninstalled by
+  * [free_env] and when the thread exits.
+  * @raise Invalid_argument if [log] is used by [with_log] in another thread. *)
+val with_log : log -> (unit -> 'a) -> 'a
+
 (** Retrieve objective value. *)
 val get_obj_val : lp -> float
 
-(** Get the primal value of the structural variable associated with a column. *)
-val get_col_primal : lp -> int -> float
+(** Status of a solution. By default, this is the status of the MIP solution
+  * when the problem is a MIP and of the basic solution otherwise. A MIP
+  * solution is never [Infeasible] nor [Unbounded]. *)
+val get_status : ?solution:solution -> lp -> status
 
-(** Get the primal values of the structural variables associated with each column. *)
-val get_col_primals : lp -> float array
+(** Get the primal value of the structural variable associated with a column,
+  * from the MIP solution when the problem is a MIP and from the basic solution
+  * otherwise. *)
+val get_col_primal : lp -> int -> float
 
-(** Get the primal value of the structural variable associated with a row. *)
+(** Get the primal values of the structural variables associated with each
+  * column. As for [get_values], they are taken from [solution], which is by
+  * default the MIP solution when the problem is a MIP and the basic solution
+  * otherwise (as for [get_col_primal]). *)
+val get_col_primals : ?solution:solution -> lp -> float array
+
+(** Get the dual values (reduced costs) of the structural variables associated
+  * with each column, from the basic solution.
+  * @raise Invalid_argument if [solution] is [Mip_solution]. *)
+val get_col_duals : ?solution:solution -> lp -> float array
+
+(** Get the primal values of the auxiliary variables associated with each row.
+  * The default [solution] is the same as for [get_col_primals]; unlike
+  * [get_row_primal], which always uses the basic solution, the values are
+  * thus taken from the MIP solution when the problem is a MIP. *)
+val get_row_primals : ?solution:solution -> lp -> float array
+
+(** Get the dual values of the auxiliary variables associated with each row,
+  * from the basic solution.
+  * @raise Invalid_argument if [solution] is [Mip_solution]. *)
+val get_row_duals : ?solution:solution -> lp -> float array
+
+(** [get_values lp what a] retrieves the values [what] of a solution at once and
+  * stores them at the beginning of [a]. By default, primal values are taken
+  * from the MIP solution when the problem is a MIP and from the basic solution
+  * otherwise, and dual values from the basic solution.
+  * @raise Invalid_argument if [a] is too short or if dual values of a MIP
+  * solution are requested. *)
+val get_values : ?solution:solution -> lp -> solution_values -> float array -> unit
+
+(** Same as [get_values] but stores the values in a bigarray. *)
+val get_values_bigarray : ?solution:solution -> lp -> solution_values -> float_vector -> unit
+
+(** Check the Karush-Kuhn-Tucker conditions of a solution, in order to assess
+  * its accuracy. By default, the MIP solution is checked when the problem is a
+  * MIP and the basic solution otherwise. *)
+val check_kkt : ?solution:solution -> lp -> kkt
+
+(** [get_basis lp rows cols] stores the statuses of the rows and columns of the
+  * current basis in [rows] and [cols], whose lengths should be the numbers of
+  * rows and columns. Statuses are encoded as follows: [1] basic, [2] non-basic
+  * on lower bound, [3] non-basic on upper bound, [4] non-basic free, [5]
+  * non-basic fixed. This compact form can be used to restart [simplex] from
+  * this basis on another similar problem (see [set_basis]). *)
+val get_basis : lp -> byte_vector -> byte_vector -> unit
+
+(** Set the statuses of rows and columns, encoded as in [get_basis]. Non-basic
+  * statuses which do not match the bounds of the variables are adjusted.
+  * @raise Invalid_argument if a vector does not have the right length or
+  * contains an invalid status. *)
+val set_basis : lp -> byte_vector -> byte_vector -> unit
+
+(** [bound_ranges lp vars lo hi] performs the sensitivity analysis of the active
+  * bounds of the rows or columns, from [first] (default: [0]) to [first + n -
+  * 1] where [n] is the length of [lo] and [hi]: for each of those non-basic
+  * variables, the range in which its value can vary without changing the
+  * basis is stored in [lo] and [hi], and [nan] is stored for basic ones. The
+  * problem should have an optimal basic solution and the factorization of the
+  * basis is reused when available. The runtime lock is released during the
+  * analysis, so that large problems can be analyzed by several threads, each
+  * working on a range of variables of its own copy of the problem (see
+  * [copy_problem]).
+  * @raise Invalid_argument if the vectors do not have the same length or the
+  * range is out of bounds.
+  * @raise Failure if the solution is not optimal. *)
+val bound_ranges : ?first:int -> lp -> variables -> float_vector -> float_vector -> unit
+
+(** Same as [bound_ranges] but stores the ranges of the objective coefficients
+  * of the variables for which the basis remains optimal. *)
+val cost_ranges : ?first:int -> lp -> variables -> float_vector -> float_vector -> unit
+
+(** Get the primal value of the auxiliary variable associated with a row, from
+  * the basic solution (use [get_row_primals ~solution:Mip_solution] for the
+  * MIP solution). *)
 val get_row_primal : lp -> int -> float
 
 (** Get the dual value of the structural variable associated with a row. *)
 val get_row_dual : lp -> int -> float
 
 
+(** {2 Simplex tableau and basis matrix}
+
+  In the following functions, variables are numbered from [0] to [m + n - 1]
+  where [m] is the number of rows and [n] the number of columns: the first [m]
+  ones are the auxiliary variables associated with the rows and the following
+  ones are the structural variables associated with the columns. Sparse
+  vectors are given by a vector of indexes and a vector of values, only their
+  first elements being used. The results of [eval_tab_row], [eval_tab_col],
+  [transform_row] and [transform_col] are written in place of the contents of
+  their vectors, which should thus not be read by other threads or domains
+  during the call, whereas the ratio tests do not modify their vectors. The
+  factorization of the basis matrix is computed if it is not available. *)
+
+(** [eval_tab_row lp k ind vals] computes the row of the simplex tableau of the
+  * basic variable [k], that is the expression of [k] in terms of non-basic
+  * variables, stores it in [ind] and [vals] and returns its number of
+  * elements. The vectors should have at least [n] elements.
+  * @raise Invalid_argument if the vectors are too short or [k] is not a basic
+  * variable. *)
+val eval_tab_row : lp -> int -> int32_vector -> float_vector -> int
+
+(** [eval_tab_col lp k ind vals] computes the column of the simplex tableau of
+  * the non-basic variable [k], that is the coefficients of [k] in the
+  * expressions of basic variables, stores it in [ind] and [vals] and returns
+  * its number of elements. The vectors should have at least [m] elements. *)
+val eval_tab_col : lp -> int -> int32_vector -> float_vector -> int
+
+(** [transform_row lp len ind vals] expresses the linear form whose [len]
+  * coefficients are given in [ind] (column indexes) and [vals] in terms of
+  * non-basic variables. The result overwrites [ind] and [vals], whose length
+  * should be at least [n], and its number of elements is returned. This is
+  * the basis of the computation of cutting planes. *)
+val transform_row : lp -> int -> int32_vector -> float_vector -> int
+
+(** Same as [transform_row] for a column whose [len] coefficients are given in
+  * [ind] (row indexes) and [vals], which is expressed in terms of basic
+  * variables. The result overwrites [ind] and [vals], which should have at
+  * least [m] elements. *)
+val transform_col : lp -> int -> int32_vector -> float_vector -> int
+
+(** [prim_ratio_test lp len ind vals incr eps] performs the primal ratio test
+  * on the column of the simplex tableau whose [len] elements are given in
+  * [ind] (basic variables) and [vals] (for instance computed by
+  * [eval_tab_col]), the non-basic variable increasing if [incr] is [true] and
+  * decreasing otherwise. It returns the basic variable which reaches its
+  * bound first, if any, coefficients smaller than [eps] in absolute value
+  * being ignored. The basic solution should be primal feasible. *)
+val prim_ratio_test : lp -> int -> int32_vector -> float_vector -> bool -> float -> int option
+
+(** Same as [prim_ratio_test] for the dual ratio test on a row of the simplex
+  * tableau ([ind] are non-basic variables), the basic variable increasing if
+  * [incr] is [true]. It returns the non-basic variable whose reduced cost
+  * reaches zero first, if any. The basic solution should be dual feasible. *)
+val dual_ratio_test : lp -> int -> int32_vector -> float_vector -> bool -> float -> int option
+
+(** Solve B x = b in place where B is the basis matrix: [x] contains [b] (of
+  * length [m]) before the call and [x] after. *)
+val ftran : lp -> float_vector -> unit
+
+(** Solve B' x = b in place where B' is the transposed basis matrix. *)
+val btran : lp -> float_vector -> unit
+
+
 (** {2 Setting parameters of the solver} *)
 
 (** Set the level of messages output by sover routines. The second argument might be:
@@ -209,6 +826,28 @@ val set_message_level : lp -> int -> unit
 (** Use the builtin LP-presolver in [simplex]? *)
 val use_presolver : lp -> bool -> unit
 
+(** Use the dual simplex in [simplex]? It is faster when starting from a dual
+  * feasible basis. *)
+val use_dual_simplex : lp -> bool -> unit
+
+(** Replace integer variables by binary ones in [branch_and_bound_opt]? *)
+val use_binarization : lp -> bool -> unit
+
+(** Set the cutting planes generated by [branch_and_bound] and
+  * [branch_and_bound_opt]. *)
+val set_cuts : lp -> cut list -> unit
+
+(** Retrieve the cutting planes generated by the branch-and-cut solver. *)
+val get_cuts : lp -> cut list
+
+(** Set the relative mip gap tolerance: the branch-and-cut solver stops as soon
+  * as the relative gap between the best integer solution and the best bound is
+  * below this value (it is 0 by default). *)
+val set_mip_gap : lp -> float -> unit
+
+(** Retrieve the relative mip gap tolerance. *)
+val get_mip_gap : lp -> float
+
 (** Initialize the simplex iteration counter. *)
 val set_simplex_iteration_count : lp -> int -> unit
 
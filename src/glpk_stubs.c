@@ -19,15 +19,33 @@
  */
 
 #include <caml/alloc.h>
+#include <caml/bigarray.h>
 #include <caml/callback.h>
 #include <caml/custom.h>
 #include <caml/fail.h>
+#include <caml/intext.h>
 #include <caml/memory.h>
 #include <caml/misc.h>
 #include <caml/mlvalues.h>
 #include <caml/signals.h>
+#include <caml/version.h>
 
 #include <assert.h>
+#include <ctype.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <float.h>
+#include <limits.h>
+#include <math.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 #include <glpk.h>
 #include "lpx.h"
@@ -72,42 +90,762 @@ static void raise_on_error(int ret)
     case LPX_E_NOCONV:
       caml_raise_constant(*caml_named_value("ocaml_glpk_exn_noconv"));
 
+    /* The relative mip gap tolerance was reached: the solution is good
+     * enough. */
+    case LPX_E_MIPGAP:
+      return;
+
     default:
       caml_raise_constant(*caml_named_value("ocaml_glpk_exn_unknown"));
   }
   assert(0); /* TODO */
 }
 
-#define Lpx_val(v) (*((LPX**)Data_custom_val(v)))
+/* Raise an exception for error codes returned by the solvers of the new API,
+ * which are translated as in lpx.c. */
+static void raise_on_glp_error(int ret)
+{
+  switch(ret)
+  {
+    case 0:
+    /* The relative mip gap tolerance was reached: the solution is good
+     * enough. */
+    case GLP_EMIPGAP:
+      return;
+
+    case GLP_EBADB:
+    case GLP_ESING:
+    case GLP_ECOND:
+    case GLP_EBOUND:
+    case GLP_EROOT:
+      raise_on_error(LPX_E_FAULT);
+
+    case GLP_EFAIL:
+    case GLP_EINSTAB:
+      raise_on_error(LPX_E_SING);
+
+    case GLP_EOBJLL:
+      raise_on_error(LPX_E_OBJLL);
+
+    case GLP_EOBJUL:
+      raise_on_error(LPX_E_OBJUL);
+
+    case GLP_EITLIM:
+      raise_on_error(LPX_E_ITLIM);
+
+    case GLP_ETMLIM:
+      raise_on_error(LPX_E_TMLIM);
+
+    case GLP_ENOPFS:
+    case GLP_ENOFEAS:
+      raise_on_error(LPX_E_NOPFS);
+
+    case GLP_ENODFS:
+      raise_on_error(LPX_E_NODFS);
+
+    case GLP_ENOCVG:
+      raise_on_error(LPX_E_NOCONV);
+
+    case GLP_ESTOP:
+      caml_raise_constant(*caml_named_value("ocaml_glpk_exn_cancelled"));
+
+    default:
+      raise_on_error(-1);
+  }
+}
+
+/* glpk keeps its environment, and in particular the list of the memory blocks
+ * it allocated, in thread-local storage. A problem thus belongs to the thread
+ * (or domain) which created it and has to be freed by this thread. Since
+ * finalizers might be run by any thread, we keep track of the environment
+ * owning each problem: a problem finalized by another thread is queued and
+ * freed by its owner the next time it creates a problem, frees its
+ * environment or exits. The environment also keeps the list of its live
+ * problems, which are marked as deleted when it is freed. */
+typedef struct pending
+{
+  LPX *lp;
+  struct pending *next;
+} pending;
+
+typedef struct prob prob;
+
+typedef struct
+{
+  pthread_mutex_t lock;
+  /* Number of problems referring to the environment, plus one while the
+   * environment has not been freed. */
+  int refcount;
+  /* Has the glpk environment been freed? */
+  int freed;
+  /* Problems waiting to be deleted by the owner. */
+  pending *pending;
+  /* Problems owned by the environment. */
+  prob *probs;
+} env;
+
+/* A problem together with its control parameters. Since the custom block can
+ * be moved by the GC, it only points to the problem, which is allocated
+ * separately. The problem is NULL once it has been deleted. */
+struct prob
+{
+  LPX *lp;
+  LPXCPS cps;
+  /* The owner, NULL once the problem has been released. The problem is in the
+   * list of the problems of its owner, which is protected by its lock. */
+  env *owner;
+  prob *prev;
+  prob *next;
+  /* Estimated size of the problem reported to the GC so far, and the part of
+   * it which was reported as dependent memory (and has to be released). */
+  uintnat mem;
+  uintnat dependent;
+  /* Buffers for a column of the matrix, with room for at least the number of
+   * rows, used when marshaling since exceptions cannot be raised then. */
+  int *ind;
+  double *val;
+  int buflen;
+};
+
+static __thread env *current_env = NULL;
+
+/* The environment of a thread is freed when the thread exits. */
+static pthread_key_t env_key;
+
+static pthread_once_t env_key_once = PTHREAD_ONCE_INIT;
+
+static void free_current_env(void);
+
+static void release_current_log(void);
+
+static void env_destructor(void *e)
+{
+  if (e == current_env)
+    free_current_env();
+}
+
+static void create_env_key(void)
+{
+  pthread_key_create(&env_key, env_destructor);
+}
+
+/* Environment of the current thread, NULL if it could not be allocated. */
+static env *get_env(void)
+{
+  env *e = current_env;
+
+  if (!e)
+  {
+    e = malloc(sizeof(env));
+    if (!e)
+      return NULL;
+    pthread_mutex_init(&e->lock, NULL);
+    e->refcount = 1;
+    e->freed = 0;
+    e->pending = NULL;
+    e->probs = NULL;
+    pthread_once(&env_key_once, create_env_key);
+    pthread_setspecific(env_key, e);
+    current_env = e;
+  }
+  return e;
+}
+
+static void env_release(env *e)
+{
+  int refcount;
+
+  pthread_mutex_lock(&e->lock);
+  refcount = --e->refcount;
+  pthread_mutex_unlock(&e->lock);
+  if (refcount == 0)
+  {
+    pthread_mutex_destroy(&e->lock);
+    free(e);
+  }
+}
+
+/* Take the list of problems waiting to be deleted. If delete is set, the
+ * problems are deleted (this should only be done by the owner), otherwise
+ * only the list is freed. */
+static void env_flush(env *e, int delete)
+{
+  pending *l, *next;
+
+  pthread_mutex_lock(&e->lock);
+  l = e->pending;
+  e->pending = NULL;
+  pthread_mutex_unlock(&e->lock);
+  while (l)
+  {
+    next = l->next;
+    if (delete)
+      lpx_delete_prob(l->lp);
+    free(l);
+    l = next;
+  }
+}
+
+/* Free the glpk environment of the current thread, together with all its
+ * problems, which are marked as deleted. This does not use the runtime, so
+ * that it can be called when the thread exits. */
+static void free_current_env(void)
+{
+  env *e = current_env;
+  prob *p;
+
+  if (e)
+  {
+    pthread_mutex_lock(&e->lock);
+    e->freed = 1;
+    for(p = e->probs; p; p = p->next)
+      p->lp = NULL;
+    pthread_mutex_unlock(&e->lock);
+    /* The problems are freed along with the environment. */
+    env_flush(e, 0);
+    current_env = NULL;
+    pthread_setspecific(env_key, NULL);
+    env_release(e);
+  }
+  /* The terminal hook goes away with the environment. */
+  release_current_log();
+  glp_free_env();
+}
+
+#define Prob_val(v) (*((prob**)Data_custom_val(v)))
+#define Cps_val(v) (&Prob_val(v)->cps)
+
+static LPX *lpx_val(value block)
+{
+  LPX *lp = Prob_val(block)->lp;
+
+  if (!lp)
+    caml_invalid_argument("Glpk: the problem has been deleted");
+  return lp;
+}
+
+#define Lpx_val(v) lpx_val(v)
+
+/* Since OCaml 5, the dependent memory is attached to a block. */
+#if OCAML_VERSION_MAJOR >= 5
+#define Alloc_dependent_memory(v, n) caml_alloc_dependent_memory(v, n)
+#define Free_dependent_memory(v, n) caml_free_dependent_memory(v, n)
+#else
+#define Alloc_dependent_memory(v, n) caml_alloc_dependent_memory(n)
+#define Free_dependent_memory(v, n) caml_free_dependent_memory(n)
+#endif
+
+/* The memory used by glpk for a problem is not known, so that we estimate it
+ * from its size: the GC only sees the few bytes of the custom block and would
+ * otherwise not hurry to collect dead problems. The constants roughly are the
+ * sizes of the structures of glpk (including the LU factorization of the
+ * basis for the elements of the matrix). */
+#define PROB_MEM 1024
+#define ROW_MEM 256
+#define ELEM_MEM 96
+
+static uintnat prob_mem(LPX *lp)
+{
+  return PROB_MEM
+    + (uintnat)(glp_get_num_rows(lp) + glp_get_num_cols(lp)) * ROW_MEM
+    + (uintnat)glp_get_num_nz(lp) * ELEM_MEM;
+}
+
+/* Report the growth of the problem of a block to the GC. Memory is only
+ * reported when the problem grows, so that the estimate is the largest size
+ * of the problem. */
+/* Make the column buffers large enough for m rows, 0 if memory is lacking. */
+static int reserve_buffers(prob *p, int m)
+{
+  int *ind;
+  double *val;
+
+  if (m <= p->buflen)
+    return 1;
+  ind = malloc((m + 1) * sizeof(int));
+  val = malloc((m + 1) * sizeof(double));
+  if (!ind || !val)
+  {
+    free(ind);
+    free(val);
+    return 0;
+  }
+  free(p->ind);
+  free(p->val);
+  p->ind = ind;
+  p->val = val;
+  p->buflen = m;
+  return 1;
+}
+
+static void account_prob(value block, prob *p)
+{
+  uintnat mem = prob_mem(p->lp);
+
+  if (!reserve_buffers(p, glp_get_num_rows(p->lp)))
+    caml_raise_out_of_memory();
+  if (mem > p->mem)
+  {
+    Alloc_dependent_memory(block, mem - p->mem);
+    p->dependent += mem - p->mem;
+    p->mem = mem;
+  }
+}
+
+/* Detach a problem from its owner, deleting it or queuing it for the owner.
+ * The problem is marked as deleted. */
+static void release_prob(prob *p)
+{
+  env *e = p->owner;
+  LPX *lp;
+  pending *l;
+
+  if (!e)
+    return;
+  pthread_mutex_lock(&e->lock);
+  if (p->prev)
+    p->prev->next = p->next;
+  else
+    e->probs = p->next;
+  if (p->next)
+    p->next->prev = p->prev;
+  /* If the environment has been freed, so has the problem. */
+  lp = p->lp;
+  p->lp = NULL;
+  p->owner = NULL;
+  if (lp && e != current_env)
+  {
+    l = malloc(sizeof(pending));
+    /* If we cannot allocate, the best we can do is leak the problem. */
+    if (l)
+    {
+      l->lp = lp;
+      l->next = e->pending;
+      e->pending = l;
+    }
+    lp = NULL;
+  }
+  pthread_mutex_unlock(&e->lock);
+  if (lp)
+    lpx_delete_prob(lp);
+  env_release(e);
+  free(p->ind);
+  free(p->val);
+  p->ind = NULL;
+  p->val = NULL;
+  p->buflen = 0;
+}
 
 static void finalize_lpx(value block)
 {
-  lpx_delete_prob(Lpx_val(block));
+  prob *p = Prob_val(block);
+
+  /* The problem is NULL if its allocation failed. */
+  if (p)
+  {
+    release_prob(p);
+    Free_dependent_memory(block, p->dependent);
+    free(p);
+  }
 }
 
+static void serialize_lpx(value block, uintnat *wsize_32, uintnat *wsize_64);
+static uintnat deserialize_lpx(void *dst);
+
 static struct custom_operations lpx_ops =
 {
   "ocaml_glpk_lpx",
   finalize_lpx,
   custom_compare_default,
   custom_hash_default,
-  custom_serialize_default,
-  custom_deserialize_default
+  serialize_lpx,
+  deserialize_lpx
 };
 
+/* Allocate a problem owned by the environment of the current thread, NULL if
+ * it could not be allocated. */
+static prob *attach_prob(LPX *lp)
+{
+  env *e = get_env();
+  prob *p;
+
+  if (!e)
+    return NULL;
+  p = malloc(sizeof(prob));
+  if (!p)
+    return NULL;
+  env_flush(e, 1);
+  p->lp = lp;
+  p->owner = e;
+  p->prev = NULL;
+  p->mem = 0;
+  p->dependent = 0;
+  p->ind = NULL;
+  p->val = NULL;
+  p->buflen = 0;
+  lpx_reset_parms(&p->cps);
+  pthread_mutex_lock(&e->lock);
+  e->refcount++;
+  p->next = e->probs;
+  if (p->next)
+    p->next->prev = p;
+  e->probs = p;
+  pthread_mutex_unlock(&e->lock);
+  return p;
+}
+
 static value new_blp(LPX* lp)
 {
-  value block = caml_alloc_custom(&lpx_ops, sizeof(LPX*), 0, 1);
-  Lpx_val(block) = lp;
+  uintnat mem = prob_mem(lp);
+  value block;
+  prob *p;
+
+  block = caml_alloc_custom_mem(&lpx_ops, sizeof(prob*), mem);
+  Prob_val(block) = NULL;
+  p = attach_prob(lp);
+  if (!p)
+  {
+    lpx_delete_prob(lp);
+    caml_raise_out_of_memory();
+  }
+  p->mem = mem;
+  Prob_val(block) = p;
+  if (!reserve_buffers(p, glp_get_num_rows(lp)))
+    caml_raise_out_of_memory();
   return block;
 }
 
+/* Serialization of problems, used by Marshal. Version of the format, to be
+ * increased when it changes. */
+#define SERIALIZE_VERSION 1
+/* Written instead of the version for deleted problems, which are unmarshaled
+ * as deleted problems: exceptions cannot be raised safely while marshaling. */
+#define SERIALIZE_DELETED 0
+
+static int distinct_indices(const int *ind, int len, int bound, int *work);
+
+static void serialize_name(const char *name)
+{
+  int len = name ? strlen(name) : -1;
+
+  caml_serialize_int_4(len);
+  if (name)
+    caml_serialize_block_1((void*)name, len);
+}
+
+/* Check that a name is accepted by glpk, which aborts otherwise: it should
+ * have at most 255 characters, none of which being a control character. */
+static int valid_name(const char *name, size_t len)
+{
+  size_t i;
+
+  if (len > 255)
+    return 0;
+  for(i = 0; i < len; i++)
+    if (iscntrl((unsigned char)name[i]))
+      return 0;
+  return 1;
+}
+
+/* The problem being deserialized by the current thread, together with the
+ * buffers used for its columns, freed on errors since the custom block is not
+ * finalized in this case. */
+static __thread struct
+{
+  prob *p;
+  int *ind;
+  double *val;
+} deserialized = { NULL, NULL, NULL };
+
+static void deserialize_error(const char *msg)
+{
+  prob *p = deserialized.p;
+
+  free(deserialized.ind);
+  free(deserialized.val);
+  deserialized.ind = NULL;
+  deserialized.val = NULL;
+  if (p)
+  {
+    deserialized.p = NULL;
+    release_prob(p);
+    free(p);
+  }
+  caml_deserialize_error((char*)msg);
+}
+
+static char *deserialize_name(char *buf)
+{
+  int len = caml_deserialize_sint_4();
+
+  if (len < 0)
+    return NULL;
+  if (len > 255)
+    deserialize_error("ocaml_glpk: invalid name");
+  caml_deserialize_block_1(buf, len);
+  if (!valid_name(buf, len))
+    deserialize_error("ocaml_glpk: invalid name");
+  buf[len] = 0;
+  return buf;
+}
+
+/* The control parameters, field by field so that the format does not depend
+ * on the architecture. */
+#define CPS_FIELDS(INT, REAL) \
+  INT(msg_lev) INT(scale) INT(dual) INT(price) REAL(relax) REAL(tol_bnd) \
+  REAL(tol_dj) REAL(tol_piv) INT(round) REAL(obj_ll) REAL(obj_ul) \
+  INT(it_lim) REAL(tm_lim) INT(out_frq) REAL(out_dly) INT(branch) \
+  INT(btrack) REAL(tol_int) REAL(tol_obj) INT(mps_info) INT(mps_obj) \
+  INT(mps_orig) INT(mps_wide) INT(mps_free) INT(mps_skip) INT(lpt_orig) \
+  INT(presol) INT(binarize) INT(use_cuts) REAL(mip_gap)
+
+static void serialize_lpx(value block, uintnat *wsize_32, uintnat *wsize_64)
+{
+  prob *p = Prob_val(block);
+  LPX *lp = p->lp;
+  LPXCPS *cps = Cps_val(block);
+  int *ind = p->ind;
+  double *val = p->val;
+  int m, n, i, j, k, len, scaled = 0;
+
+  *wsize_32 = 4;
+  *wsize_64 = 8;
+  if (!lp)
+  {
+    caml_serialize_int_4(SERIALIZE_DELETED);
+    return;
+  }
+  m = glp_get_num_rows(lp);
+  n = glp_get_num_cols(lp);
+  /* The buffers were reserved when the problem got its rows. */
+  assert(m <= p->buflen);
+  caml_serialize_int_4(SERIALIZE_VERSION);
+  serialize_name(glp_get_prob_name(lp));
+  serialize_name(glp_get_obj_name(lp));
+  caml_serialize_int_1(glp_get_obj_dir(lp));
+  caml_serialize_float_8(glp_get_obj_coef(lp, 0));
+  caml_serialize_int_4(m);
+  caml_serialize_int_4(n);
+  for(i = 1; i <= m; i++)
+  {
+    serialize_name(glp_get_row_name(lp, i));
+    caml_serialize_int_1(glp_get_row_type(lp, i));
+    caml_serialize_float_8(glp_get_row_lb(lp, i));
+    caml_serialize_float_8(glp_get_row_ub(lp, i));
+    caml_serialize_int_1(glp_get_row_stat(lp, i));
+    scaled = scaled || glp_get_rii(lp, i) != 1.0;
+  }
+  for(j = 1; j <= n; j++)
+  {
+    serialize_name(glp_get_col_name(lp, j));
+    caml_serialize_int_1(glp_get_col_type(lp, j));
+    caml_serialize_float_8(glp_get_col_lb(lp, j));
+    caml_serialize_float_8(glp_get_col_ub(lp, j));
+    caml_serialize_int_1(glp_get_col_stat(lp, j));
+    caml_serialize_int_1(glp_get_col_kind(lp, j));
+    caml_serialize_float_8(glp_get_obj_coef(lp, j));
+    scaled = scaled || glp_get_sjj(lp, j) != 1.0;
+    /* The matrix is stored by columns. */
+    len = glp_get_mat_col(lp, j, ind, val);
+    caml_serialize_int_4(len);
+    for(k = 1; k <= len; k++)
+    {
+      caml_serialize_int_4(ind[k]);
+      caml_serialize_float_8(val[k]);
+    }
+  }
+  /* Scaling factors, only when the problem is scaled. */
+  caml_serialize_int_1(scaled);
+  if (scaled)
+  {
+    for(i = 1; i <= m; i++)
+      caml_serialize_float_8(glp_get_rii(lp, i));
+    for(j = 1; j <= n; j++)
+      caml_serialize_float_8(glp_get_sjj(lp, j));
+  }
+#define SERIALIZE_INT(f) caml_serialize_int_4(cps->f);
+#define SERIALIZE_REAL(f) caml_serialize_float_8(cps->f);
+  CPS_FIELDS(SERIALIZE_INT, SERIALIZE_REAL)
+#undef SERIALIZE_INT
+#undef SERIALIZE_REAL
+}
+
+/* Deserialize a glpk constant, checking it since glpk aborts on invalid ones. */
+static int deserialize_code(int min, int max)
+{
+  int x = caml_deserialize_uint_1();
+
+  if (x < min || x > max)
+    deserialize_error("ocaml_glpk: invalid data");
+  return x;
+}
+
+static uintnat deserialize_lpx(void *dst)
+{
+  prob *p;
+  LPXCPS *cps;
+  char name[256];
+  int *ind, m, n, i, j, k, len, type, stat;
+  double *val, lb, ub;
+  LPX *lp;
+
+  switch (caml_deserialize_uint_4())
+  {
+  case SERIALIZE_VERSION:
+    break;
+  case SERIALIZE_DELETED:
+    p = malloc(sizeof(prob));
+    if (!p)
+      caml_deserialize_error("ocaml_glpk: out of memory");
+    p->lp = NULL;
+    p->owner = NULL;
+    p->prev = p->next = NULL;
+    p->mem = 0;
+    p->dependent = 0;
+    p->ind = NULL;
+    p->val = NULL;
+    p->buflen = 0;
+    lpx_reset_parms(&p->cps);
+    *((prob**)dst) = p;
+    return sizeof(prob*);
+  default:
+    caml_deserialize_error("ocaml_glpk: unsupported format");
+  }
+  lp = glp_create_prob();
+  p = attach_prob(lp);
+  if (!p)
+  {
+    lpx_delete_prob(lp);
+    caml_deserialize_error("ocaml_glpk: out of memory");
+  }
+  /* The block only points to the problem once it is complete. */
+  *((prob**)dst) = NULL;
+  deserialized.p = p;
+  cps = &p->cps;
+  glp_set_prob_name(lp, deserialize_name(name));
+  glp_set_obj_name(lp, deserialize_name(name));
+  glp_set_obj_dir(lp, deserialize_code(GLP_MIN, GLP_MAX));
+  glp_set_obj_coef(lp, 0, caml_deserialize_float_8());
+  m = caml_deserialize_sint_4();
+  n = caml_deserialize_sint_4();
+  if (m < 0 || n < 0)
+    deserialize_error("ocaml_glpk: invalid dimensions");
+  if (m > 0)
+    glp_add_rows(lp, m);
+  if (n > 0)
+    glp_add_cols(lp, n);
+  for(i = 1; i <= m; i++)
+  {
+    glp_set_row_name(lp, i, deserialize_name(name));
+    type = deserialize_code(GLP_FR, GLP_FX);
+    lb = caml_deserialize_float_8();
+    ub = caml_deserialize_float_8();
+    glp_set_row_bnds(lp, i, type, lb, ub);
+    glp_set_row_stat(lp, i, deserialize_code(GLP_BS, GLP_NS));
+  }
+  /* The indices of a column are followed by room for checking them. */
+  ind = deserialized.ind = malloc((2 * m + 1) * sizeof(int));
+  val = deserialized.val = malloc((m + 1) * sizeof(double));
+  if (!ind || !val)
+    deserialize_error("ocaml_glpk: out of memory");
+  for(j = 1; j <= n; j++)
+  {
+    glp_set_col_name(lp, j, deserialize_name(name));
+    type = deserialize_code(GLP_FR, GLP_FX);
+    lb = caml_deserialize_float_8();
+    ub = caml_deserialize_float_8();
+    stat = deserialize_code(GLP_BS, GLP_NS);
+    glp_set_col_kind(lp, j, deserialize_code(GLP_CV, GLP_BV));
+    glp_set_col_bnds(lp, j, type, lb, ub);
+    glp_set_col_stat(lp, j, stat);
+    glp_set_obj_coef(lp, j, caml_deserialize_float_8());
+    len = caml_deserialize_sint_4();
+    if (len < 0 || len > m)
+      break;
+    for(k = 1; k <= len; k++)
+    {
+      ind[k] = caml_deserialize_sint_4();
+      val[k] = caml_deserialize_float_8();
+    }
+    if (!distinct_indices(ind, len, m, ind + m + 1))
+      break;
+    glp_set_mat_col(lp, j, len, ind, val);
+  }
+  if (j <= n)
+    deserialize_error("ocaml_glpk: invalid matrix");
+  free(ind);
+  free(val);
+  deserialized.ind = NULL;
+  deserialized.val = NULL;
+  if (caml_deserialize_uint_1())
+  {
+    for(i = 1; i <= m; i++)
+      glp_set_rii(lp, i, caml_deserialize_float_8());
+    for(j = 1; j <= n; j++)
+      glp_set_sjj(lp, j, caml_deserialize_float_8());
+  }
+#define DESERIALIZE_INT(f) cps->f = caml_deserialize_sint_4();
+#define DESERIALIZE_REAL(f) cps->f = caml_deserialize_float_8();
+  CPS_FIELDS(DESERIALIZE_INT, DESERIALIZE_REAL)
+#undef DESERIALIZE_INT
+#undef DESERIALIZE_REAL
+  if (!reserve_buffers(p, m))
+    deserialize_error("ocaml_glpk: out of memory");
+  deserialized.p = NULL;
+  *((prob**)dst) = p;
+  /* The block is not known yet. */
+  account_prob(Val_unit, p);
+
+  return sizeof(prob*);
+}
+
+CAMLprim value ocaml_glpk_init(value unit)
+{
+  caml_register_custom_operations(&lpx_ops);
+  return Val_unit;
+}
+
+CAMLprim value ocaml_glpk_free_env(value unit)
+{
+  free_current_env();
+  return Val_unit;
+}
+
 CAMLprim value ocaml_glpk_new_prob(value unit)
 {
   LPX *lp = lpx_create_prob();
   return new_blp(lp);
 }
 
+CAMLprim value ocaml_glpk_delete_prob(value blp)
+{
+  prob *p = Prob_val(blp);
+
+  release_prob(p);
+  Free_dependent_memory(blp, p->dependent);
+  p->dependent = 0;
+  return Val_unit;
+}
+
+CAMLprim value ocaml_glpk_mem_usage(value blp)
+{
+  Lpx_val(blp);
+  return Val_long(Prob_val(blp)->mem);
+}
+
+CAMLprim value ocaml_glpk_copy_prob(value blp, value names)
+{
+  CAMLparam2(blp, names);
+  CAMLlocal1(ans);
+  LPX *src = Lpx_val(blp);
+  LPX *lp = lpx_create_prob();
+
+  glp_copy_prob(lp, src, Bool_val(names) ? GLP_ON : GLP_OFF);
+  ans = new_blp(lp);
+  *Cps_val(ans) = *Cps_val(blp);
+  CAMLreturn(ans);
+}
+
 CAMLprim value ocaml_glpk_set_prob_name(value blp, value name)
 {
   LPX *lp = Lpx_val(blp);
@@ -165,6 +903,7 @@ CAMLprim value ocaml_glpk_add_rows(value blp, value n)
 {
   LPX *lp = Lpx_val(blp);
   lpx_add_rows(lp, Int_val(n));
+  account_prob(blp, Prob_val(blp));
   return Val_unit;
 }
 
@@ -195,6 +934,7 @@ CAMLprim value ocaml_glpk_add_cols(value blp, value n)
 {
   LPX *lp = Lpx_val(blp);
   lpx_add_cols(lp, Int_val(n));
+  account_prob(blp, Prob_val(blp));
   return Val_unit;
 }
 
@@ -262,6 +1002,7 @@ CAMLprim value ocaml_glpk_load_matrix(value blp, value matrix)
     }
   }
   lpx_load_matrix(lp, n - 1, ia, ja, ar);
+  account_prob(blp, Prob_val(blp));
 
   free(ia);
   free(ja);
@@ -291,6 +1032,7 @@ CAMLprim value ocaml_glpk_load_sparse_matrix(value blp, value matrix)
     ar[i+1] = Double_val(Field(e, 1));
   }
   lpx_load_matrix(lp, len, ia, ja, ar);
+  account_prob(blp, Prob_val(blp));
 
   free(ia);
   free(ja);
@@ -299,106 +1041,726 @@ CAMLprim value ocaml_glpk_load_sparse_matrix(value blp, value matrix)
   return Val_unit;
 }
 
-CAMLprim value ocaml_glpk_simplex(value blp)
+/* Indices are 0-based on the OCaml side and 1-based in glpk. Index arrays
+ * filled by glpk in bigarrays are shifted in place afterwards, while index
+ * arrays read by glpk are copied. */
+static int check_indices(const int *ind, intnat len, int bound)
 {
-  CAMLparam1(blp);
-  LPX *lp = Lpx_val(blp);
-  int ret;
-
-  caml_enter_blocking_section();
-  ret = lpx_simplex(lp);
-  caml_leave_blocking_section();
+  intnat k;
 
-  raise_on_error(ret);
-  CAMLreturn(Val_unit);
+  for(k = 0; k < len; k++)
+    if (ind[k] < 0 || ind[k] >= bound)
+      return 0;
+  return 1;
 }
 
-CAMLprim value ocaml_glpk_get_obj_val(value blp)
+static void shift_indices(int *ind, intnat len, int delta)
 {
-  LPX *lp = Lpx_val(blp);
-  double ans;
-  if (lpx_get_class(lp) == LPX_MIP)
-    ans = lpx_mip_obj_val(lp);
-  else
-    ans = lpx_get_obj_val(lp);
-  return caml_copy_double(ans);
-}
+  intnat k;
 
-CAMLprim value ocaml_glpk_get_col_prim(value blp, value n)
-{
-  LPX *lp = Lpx_val(blp);
-  double ans;
-  /* TODO: is it the right thing to do? */
-  if (lpx_get_class(lp) == LPX_MIP)
-    ans = lpx_mip_col_val(lp, Int_val(n) + 1);
-  else
-    ans = lpx_get_col_prim(lp, Int_val(n) + 1);
-  return caml_copy_double(ans);
+  for(k = 0; k < len; k++)
+    ind[k] += delta;
 }
 
-CAMLprim value ocaml_glpk_get_row_prim(value blp, value n)
+/* Copy of indices as a 1-based array of 1-based indices, NULL if it could not
+ * be allocated. The indices of bigarrays are not modified, since they might be
+ * shared with other threads or mapped read-only. */
+static int *one_based_indices(const int *ind, intnat len)
 {
-  LPX *lp = Lpx_val(blp);
-  return caml_copy_double(lpx_get_row_prim(lp, Int_val(n) + 1));
+  int *ans = malloc((len + 1) * sizeof(int));
+  intnat k;
+
+  if (ans)
+    for(k = 0; k < len; k++)
+      ans[k+1] = ind[k] + 1;
+  return ans;
 }
 
-CAMLprim value ocaml_glpk_get_row_dual(value blp, value n)
+#define Ba_len(v) (Caml_ba_array_val(v)->dim[0])
+
+/* Check that the 1-based (row, column) pairs of a matrix in coordinate form,
+ * which should be in bounds, are pairwise distinct, as required by glpk which
+ * would abort otherwise. The columns are bucketed by row and marked with the
+ * row they were last seen in, in linear time. Returns -1 if memory is
+ * lacking. */
+static int distinct_pairs(const int *ia, const int *ja, intnat len, int m, int n)
 {
-  LPX *lp = Lpx_val(blp);
-  return caml_copy_double(lpx_get_row_dual(lp, Int_val(n) + 1));
+  int *start = calloc(m + 2, sizeof(int));
+  int *cols = malloc((len + 1) * sizeof(int));
+  int *seen = calloc(n + 1, sizeof(int));
+  int i, ok = 1;
+  intnat k;
+
+  if (!start || !cols || !seen)
+  {
+    ok = -1;
+    goto done;
+  }
+  for(k = 1; k <= len; k++)
+    start[ia[k] + 1]++;
+  for(i = 1; i <= m; i++)
+    start[i + 1] += start[i];
+  /* start[i] is the next free position of the bucket of row i. */
+  for(k = 1; k <= len; k++)
+    cols[start[ia[k]]++] = ja[k];
+  /* Now start[i] is the end of the bucket of row i. */
+  for(i = 1, k = 0; i <= m && ok; i++)
+    for(; k < start[i]; k++)
+    {
+      if (seen[cols[k]] == i)
+      {
+        ok = 0;
+        break;
+      }
+      seen[cols[k]] = i;
+    }
+done:
+  free(start);
+  free(cols);
+  free(seen);
+  return ok;
 }
 
-CAMLprim value ocaml_glpk_get_num_rows(value blp)
+CAMLprim value ocaml_glpk_load_sparse_matrix_bigarray(value blp, value via, value vja, value var)
 {
   LPX *lp = Lpx_val(blp);
-  return Val_int(lpx_get_num_rows(lp));
+  /* int32 bigarrays are directly usable as C int arrays. */
+  int *ia = (int*)Caml_ba_data_val(via);
+  int *ja = (int*)Caml_ba_data_val(vja);
+  double *ar = (double*)Caml_ba_data_val(var);
+  intnat len = Ba_len(via);
+  int *ia1, *ja1;
+  int ok;
+
+  if (Ba_len(vja) != len || Ba_len(var) != len || len > INT_MAX)
+    caml_invalid_argument("load_sparse_matrix_bigarray");
+  if (!check_indices(ia, len, lpx_get_num_rows(lp)) ||
+      !check_indices(ja, len, lpx_get_num_cols(lp)))
+    caml_invalid_argument("load_sparse_matrix_bigarray");
+
+  ia1 = one_based_indices(ia, len);
+  ja1 = one_based_indices(ja, len);
+  ok = ia1 && ja1 ? distinct_pairs(ia1, ja1, len, lpx_get_num_rows(lp), lpx_get_num_cols(lp)) : -1;
+  if (ok != 1)
+  {
+    free(ia1);
+    free(ja1);
+    if (ok < 0)
+      caml_raise_out_of_memory();
+    caml_invalid_argument("load_sparse_matrix_bigarray");
+  }
+  /* glpk reads the arrays starting from index 1. */
+  lpx_load_matrix(lp, len, ia1, ja1, ar - 1);
+  free(ia1);
+  free(ja1);
+  account_prob(blp, Prob_val(blp));
+
+  return Val_unit;
 }
 
-CAMLprim value ocaml_glpk_get_num_cols(value blp)
+/* Load a matrix in compressed sparse row (or column) format: the elements of
+ * the i-th row (or column) are stored at positions ptr[i] to ptr[i+1]-1 of ind
+ * and val. */
+static void load_compressed_matrix(LPX *lp, value vptr, value vind, value vval, int by_row, const char *fname)
 {
-  LPX *lp = Lpx_val(blp);
-  return Val_int(lpx_get_num_cols(lp));
+  int *ptr = (int*)Caml_ba_data_val(vptr);
+  int *ind = (int*)Caml_ba_data_val(vind);
+  double *val = (double*)Caml_ba_data_val(vval);
+  int m = lpx_get_num_rows(lp);
+  int n = lpx_get_num_cols(lp);
+  int dim = by_row ? m : n;
+  intnat len = Ba_len(vind);
+  int *ind1, *work;
+  int i, ok = 1;
+
+  if (Ba_len(vptr) != dim + 1 || Ba_len(vval) != len || len > INT_MAX)
+    caml_invalid_argument(fname);
+  if (ptr[0] < 0 || ptr[dim] > len)
+    caml_invalid_argument(fname);
+  for(i = 0; i < dim; i++)
+    if (ptr[i] > ptr[i+1])
+      caml_invalid_argument(fname);
+  if (!check_indices(ind + ptr[0], ptr[dim] - ptr[0], by_row ? n : m))
+    caml_invalid_argument(fname);
+
+  /* Only the used part of the indexes is copied, shifted by ptr[0]. */
+  ind1 = one_based_indices(ind + ptr[0], ptr[dim] - ptr[0]);
+  work = malloc((ptr[dim] - ptr[0] + 1) * sizeof(int));
+  if (!ind1 || !work)
+  {
+    free(ind1);
+    free(work);
+    caml_raise_out_of_memory();
+  }
+  /* Indexes should not be repeated within a row (or column), which is checked
+   * before the previous matrix is removed. */
+  for(i = 0; i < dim && ok; i++)
+    ok = distinct_indices(ind1 + ptr[i] - ptr[0], ptr[i+1] - ptr[i], by_row ? n : m, work);
+  free(work);
+  if (!ok)
+  {
+    free(ind1);
+    caml_invalid_argument(fname);
+  }
+  /* Remove the previous matrix. */
+  lpx_load_matrix(lp, 0, NULL, NULL, NULL);
+  for(i = 0; i < dim; i++)
+  {
+    /* glpk reads the arrays starting from index 1. */
+    if (by_row)
+      lpx_set_mat_row(lp, i + 1, ptr[i+1] - ptr[i], ind1 + ptr[i] - ptr[0], val + ptr[i] - 1);
+    else
+      lpx_set_mat_col(lp, i + 1, ptr[i+1] - ptr[i], ind1 + ptr[i] - ptr[0], val + ptr[i] - 1);
+  }
+  free(ind1);
 }
 
-CAMLprim value ocaml_glpk_scale_problem(value blp)
+CAMLprim value ocaml_glpk_load_csr_matrix(value blp, value vptr, value vind, value vval)
 {
-  LPX *lp = Lpx_val(blp);
-  lpx_scale_prob(lp);
+  load_compressed_matrix(Lpx_val(blp), vptr, vind, vval, 1, "load_csr_matrix");
+  account_prob(blp, Prob_val(blp));
   return Val_unit;
 }
 
-CAMLprim value ocaml_glpk_unscale_problem(value blp)
+CAMLprim value ocaml_glpk_load_csc_matrix(value blp, value vptr, value vind, value vval)
 {
-  LPX *lp = Lpx_val(blp);
-  lpx_unscale_prob(lp);
+  load_compressed_matrix(Lpx_val(blp), vptr, vind, vval, 0, "load_csc_matrix");
+  account_prob(blp, Prob_val(blp));
   return Val_unit;
 }
 
-/* TODO */
-/*
-CAMLprim value ocaml_glpk_check_kkt(value blp, value scaled, value vkkt)
+static int compare_ints(const void *a, const void *b)
 {
+  int x = *(const int*)a;
+  int y = *(const int*)b;
 
+  return (x > y) - (x < y);
 }
-*/
 
-CAMLprim value ocaml_glpk_interior(value blp)
+/* Check that 1-based indices are in bounds and pairwise distinct, as required
+ * by glpk which would abort otherwise. The indices are sorted in work, which
+ * should have room for len integers, so that the cost does not depend on the
+ * size of the problem. */
+static int distinct_indices(const int *ind, int len, int bound, int *work)
 {
-  CAMLparam1(blp);
-  LPX *lp = Lpx_val(blp);
-  int ret;
-
-  caml_enter_blocking_section();
-  ret = lpx_interior(lp);
-  caml_leave_blocking_section();
-
-  raise_on_error(ret);
-  CAMLreturn(Val_unit);
+  int k;
+
+  if (len == 0)
+    return 1;
+  memcpy(work, ind + 1, len * sizeof(int));
+  qsort(work, len, sizeof(int), compare_ints);
+  if (work[0] < 1 || work[len - 1] > bound)
+    return 0;
+  for(k = 1; k < len; k++)
+    if (work[k] == work[k - 1])
+      return 0;
+  return 1;
 }
 
-static int class_table[] = {LPX_LP, LPX_MIP};
-
-CAMLprim value ocaml_glpk_set_class(value blp, value class)
+/* Replace a row (or column) of the matrix by the elements of an array of
+ * (index, value) pairs. */
+static void set_mat_vector(LPX *lp, value vn, value vec, int by_row, const char *fname)
+{
+  int n = Int_val(vn) + 1;
+  int len = Wosize_val(vec);
+  int *ind;
+  double *val;
+  int k, ok;
+
+  if (n < 1 || n > (by_row ? lpx_get_num_rows(lp) : lpx_get_num_cols(lp)))
+    caml_invalid_argument(fname);
+  /* The indices are followed by room for checking them. */
+  ind = (int*)malloc((2 * len + 1) * sizeof(int));
+  val = (double*)malloc((len + 1) * sizeof(double));
+  for(k = 0; k < len; k++)
+  {
+    ind[k+1] = Int_val(Field(Field(vec, k), 0)) + 1;
+    val[k+1] = Double_val(Field(Field(vec, k), 1));
+  }
+  ok = distinct_indices(ind, len, by_row ? lpx_get_num_cols(lp) : lpx_get_num_rows(lp), ind + len + 1);
+  if (ok)
+  {
+    if (by_row)
+      lpx_set_mat_row(lp, n, len, ind, val);
+    else
+      lpx_set_mat_col(lp, n, len, ind, val);
+  }
+  free(ind);
+  free(val);
+  if (!ok)
+    caml_invalid_argument(fname);
+}
+
+CAMLprim value ocaml_glpk_set_mat_row(value blp, value n, value row)
+{
+  set_mat_vector(Lpx_val(blp), n, row, 1, "set_mat_row");
+  account_prob(blp, Prob_val(blp));
+  return Val_unit;
+}
+
+CAMLprim value ocaml_glpk_set_mat_col(value blp, value n, value col)
+{
+  set_mat_vector(Lpx_val(blp), n, col, 0, "set_mat_col");
+  account_prob(blp, Prob_val(blp));
+  return Val_unit;
+}
+
+static void del_vectors(LPX *lp, value vnum, int rows, const char *fname)
+{
+  int len = Wosize_val(vnum);
+  int *num;
+  int k, ok;
+
+  if (len == 0)
+    return;
+  num = (int*)malloc((2 * len + 1) * sizeof(int));
+  for(k = 0; k < len; k++)
+    num[k+1] = Int_val(Field(vnum, k)) + 1;
+  ok = distinct_indices(num, len, rows ? lpx_get_num_rows(lp) : lpx_get_num_cols(lp), num + len + 1);
+  if (ok)
+  {
+    if (rows)
+      lpx_del_rows(lp, len, num);
+    else
+      lpx_del_cols(lp, len, num);
+  }
+  free(num);
+  if (!ok)
+    caml_invalid_argument(fname);
+}
+
+CAMLprim value ocaml_glpk_del_rows(value blp, value num)
+{
+  del_vectors(Lpx_val(blp), num, 1, "del_rows");
+  return Val_unit;
+}
+
+CAMLprim value ocaml_glpk_del_cols(value blp, value num)
+{
+  del_vectors(Lpx_val(blp), num, 0, "del_columns");
+  return Val_unit;
+}
+
+CAMLprim value ocaml_glpk_simplex(value blp)
+{
+  CAMLparam1(blp);
+  LPX *lp = Lpx_val(blp);
+  /* The block might be moved by the GC during the blocking section. */
+  LPXCPS cps = *Cps_val(blp);
+  int ret;
+
+  caml_enter_blocking_section();
+  ret = lpx_simplex(lp, &cps);
+  caml_leave_blocking_section();
+
+  raise_on_error(ret);
+  CAMLreturn(Val_unit);
+}
+
+CAMLprim value ocaml_glpk_reoptimize(value blp)
+{
+  CAMLparam1(blp);
+  LPX *lp = Lpx_val(blp);
+  LPXCPS cps = *Cps_val(blp);
+  int ret;
+
+  /* The presolver would discard the current basis. */
+  lpx_set_int_parm(lp, &cps, LPX_K_DUAL, 1);
+  lpx_set_int_parm(lp, &cps, LPX_K_PRESOL, 0);
+  caml_enter_blocking_section();
+  /* Deleting rows or columns may leave an invalid basis, in which case we have
+   * to restart from a new one. */
+  if (!glp_bf_exists(lp) && glp_factorize(lp) != 0)
+    glp_adv_basis(lp, 0);
+  ret = lpx_simplex(lp, &cps);
+  caml_leave_blocking_section();
+
+  raise_on_error(ret);
+  CAMLreturn(Val_unit);
+}
+
+/* Set the bounds of a row (or column), infinite values meaning no bound. */
+static void set_bounds(LPX *lp, int by_row, int i, double lb, double ub)
+{
+  int type;
+
+  if (lb <= -DBL_MAX && ub >= DBL_MAX)
+    type = LPX_FR;
+  else if (ub >= DBL_MAX)
+    type = LPX_LO;
+  else if (lb <= -DBL_MAX)
+    type = LPX_UP;
+  else if (lb == ub)
+    type = LPX_FX;
+  else
+    type = LPX_DB;
+  if (by_row)
+    lpx_set_row_bnds(lp, i, type, lb, ub);
+  else
+    lpx_set_col_bnds(lp, i, type, lb, ub);
+}
+
+/* Matrix of an optional argument, with one row per scenario, or NULL. */
+static double *scenario_matrix(value v, intnat scenarios, int len)
+{
+  struct caml_ba_array *ba;
+
+  if (Is_long(v))
+    return NULL;
+  ba = Caml_ba_array_val(Field(v, 0));
+  if (ba->dim[0] != scenarios || ba->dim[1] != len)
+    caml_invalid_argument("solve_scenarios");
+  return (double*)ba->data;
+}
+
+/* Use the bounds of a scenario for the rows (or columns), current bounds being
+ * used when not specified. */
+static void set_scenario_bounds(LPX *lp, int by_row, int n, const double *lb, const double *ub)
+{
+  int i;
+
+  if (!lb && !ub)
+    return;
+  for(i = 0; i < n; i++)
+    set_bounds(lp, by_row, i + 1,
+               lb ? lb[i] : (by_row ? glp_get_row_lb(lp, i + 1) : glp_get_col_lb(lp, i + 1)),
+               ub ? ub[i] : (by_row ? glp_get_row_ub(lp, i + 1) : glp_get_col_ub(lp, i + 1)));
+}
+
+CAMLprim value ocaml_glpk_solve_scenarios(value blp, value bounds, value results, value vobj)
+{
+  CAMLparam4(blp, bounds, results, vobj);
+  LPX *lp = Lpx_val(blp);
+  LPXCPS cps = *Cps_val(blp);
+  int m = lpx_get_num_rows(lp);
+  int n = lpx_get_num_cols(lp);
+  intnat scenarios = Ba_len(vobj);
+  double *obj = (double*)Caml_ba_data_val(vobj);
+  double *row_lb = scenario_matrix(Field(bounds, 0), scenarios, m);
+  double *row_ub = scenario_matrix(Field(bounds, 1), scenarios, m);
+  double *col_lb = scenario_matrix(Field(bounds, 2), scenarios, n);
+  double *col_ub = scenario_matrix(Field(bounds, 3), scenarios, n);
+  double *col_prim = scenario_matrix(Field(results, 0), scenarios, n);
+  double *row_dual = scenario_matrix(Field(results, 1), scenarios, m);
+  double *saved;
+  intnat s;
+  int i, ok;
+
+  /* Original bounds, restored at the end. */
+  saved = malloc((2 * m + 2 * n + 1) * sizeof(double));
+  if (!saved)
+    caml_raise_out_of_memory();
+  for(i = 0; i < m; i++)
+  {
+    saved[i] = glp_get_row_lb(lp, i + 1);
+    saved[m + i] = glp_get_row_ub(lp, i + 1);
+  }
+  for(i = 0; i < n; i++)
+  {
+    saved[2 * m + i] = glp_get_col_lb(lp, i + 1);
+    saved[2 * m + n + i] = glp_get_col_ub(lp, i + 1);
+  }
+  /* Changing bounds keeps the basis dual feasible. */
+  lpx_set_int_parm(lp, &cps, LPX_K_DUAL, 1);
+  lpx_set_int_parm(lp, &cps, LPX_K_PRESOL, 0);
+
+  caml_enter_blocking_section();
+  for(s = 0; s < scenarios; s++)
+  {
+    set_scenario_bounds(lp, 1, m, row_lb ? row_lb + s * m : NULL, row_ub ? row_ub + s * m : NULL);
+    set_scenario_bounds(lp, 0, n, col_lb ? col_lb + s * n : NULL, col_ub ? col_ub + s * n : NULL);
+    /* A failure in a previous scenario may have left an invalid basis. */
+    if (!glp_bf_exists(lp) && glp_factorize(lp) != 0)
+      glp_adv_basis(lp, 0);
+    ok = lpx_simplex(lp, &cps) == LPX_E_OK && glp_get_status(lp) == GLP_OPT;
+    obj[s] = ok ? glp_get_obj_val(lp) : NAN;
+    if (col_prim)
+      for(i = 0; i < n; i++)
+        col_prim[s * n + i] = ok ? glp_get_col_prim(lp, i + 1) : NAN;
+    if (row_dual)
+      for(i = 0; i < m; i++)
+        row_dual[s * m + i] = ok ? glp_get_row_dual(lp, i + 1) : NAN;
+  }
+  for(i = 0; i < m; i++)
+    set_bounds(lp, 1, i + 1, saved[i], saved[m + i]);
+  for(i = 0; i < n; i++)
+    set_bounds(lp, 0, i + 1, saved[2 * m + i], saved[2 * m + n + i]);
+  caml_leave_blocking_section();
+  free(saved);
+
+  CAMLreturn(Val_unit);
+}
+
+CAMLprim value ocaml_glpk_get_obj_val(value blp)
+{
+  LPX *lp = Lpx_val(blp);
+  double ans;
+  if (lpx_get_class(lp) == LPX_MIP)
+    ans = lpx_mip_obj_val(lp);
+  else
+    ans = lpx_get_obj_val(lp);
+  return caml_copy_double(ans);
+}
+
+CAMLprim value ocaml_glpk_get_col_prim(value blp, value n)
+{
+  LPX *lp = Lpx_val(blp);
+  double ans;
+  /* TODO: is it the right thing to do? */
+  if (lpx_get_class(lp) == LPX_MIP)
+    ans = lpx_mip_col_val(lp, Int_val(n) + 1);
+  else
+    ans = lpx_get_col_prim(lp, Int_val(n) + 1);
+  return caml_copy_double(ans);
+}
+
+CAMLprim value ocaml_glpk_get_row_prim(value blp, value n)
+{
+  LPX *lp = Lpx_val(blp);
+  return caml_copy_double(lpx_get_row_prim(lp, Int_val(n) + 1));
+}
+
+CAMLprim value ocaml_glpk_get_row_dual(value blp, value n)
+{
+  LPX *lp = Lpx_val(blp);
+  return caml_copy_double(lpx_get_row_dual(lp, Int_val(n) + 1));
+}
+
+typedef double (*value_getter)(LPX*, int);
+
+/* Indexed by solution, then by values (see glpk.ml). */
+static value_getter value_getter_table[2][4] =
+{
+  {lpx_get_col_prim, lpx_get_col_dual, lpx_get_row_prim, lpx_get_row_dual},
+  {lpx_mip_col_val, NULL, lpx_mip_row_val, NULL}
+};
+
+/* Check the arguments of the get_values functions and return the number of
+ * values to retrieve. */
+static int values_count(LPX *lp, value sol, value what, intnat len)
+{
+  int n;
+
+  if (!value_getter_table[Int_val(sol)][Int_val(what)])
+    caml_invalid_argument("get_values: no dual values for MIP solutions");
+  n = Int_val(what) < 2 ? lpx_get_num_cols(lp) : lpx_get_num_rows(lp);
+  if (len < n)
+    caml_invalid_argument("get_values: array too short");
+  return n;
+}
+
+CAMLprim value ocaml_glpk_get_values(value blp, value sol, value what, value a)
+{
+  LPX *lp = Lpx_val(blp);
+  value_getter get = value_getter_table[Int_val(sol)][Int_val(what)];
+  int n = values_count(lp, sol, what, Wosize_val(a) / Double_wosize);
+  int i;
+
+  for(i = 0; i < n; i++)
+    Store_double_field(a, i, get(lp, i + 1));
+  return Val_unit;
+}
+
+CAMLprim value ocaml_glpk_get_values_bigarray(value blp, value sol, value what, value a)
+{
+  LPX *lp = Lpx_val(blp);
+  value_getter get = value_getter_table[Int_val(sol)][Int_val(what)];
+  int n = values_count(lp, sol, what, Ba_len(a));
+  double *data = (double*)Caml_ba_data_val(a);
+  int i;
+
+  for(i = 0; i < n; i++)
+    data[i] = get(lp, i + 1);
+  return Val_unit;
+}
+
+/* Statuses of rows and columns are stored in byte vectors using the GLP_BS,
+ * GLP_NL, GLP_NU, GLP_NF and GLP_NS codes (from 1 to 5). */
+CAMLprim value ocaml_glpk_get_basis(value blp, value vrows, value vcols)
+{
+  LPX *lp = Lpx_val(blp);
+  unsigned char *rows = (unsigned char*)Caml_ba_data_val(vrows);
+  unsigned char *cols = (unsigned char*)Caml_ba_data_val(vcols);
+  int m = lpx_get_num_rows(lp);
+  int n = lpx_get_num_cols(lp);
+  int i;
+
+  if (Ba_len(vrows) != m || Ba_len(vcols) != n)
+    caml_invalid_argument("get_basis");
+  for(i = 0; i < m; i++)
+    rows[i] = glp_get_row_stat(lp, i + 1);
+  for(i = 0; i < n; i++)
+    cols[i] = glp_get_col_stat(lp, i + 1);
+  return Val_unit;
+}
+
+CAMLprim value ocaml_glpk_set_basis(value blp, value vrows, value vcols)
+{
+  LPX *lp = Lpx_val(blp);
+  unsigned char *rows = (unsigned char*)Caml_ba_data_val(vrows);
+  unsigned char *cols = (unsigned char*)Caml_ba_data_val(vcols);
+  int m = lpx_get_num_rows(lp);
+  int n = lpx_get_num_cols(lp);
+  int i;
+
+  if (Ba_len(vrows) != m || Ba_len(vcols) != n)
+    caml_invalid_argument("set_basis");
+  for(i = 0; i < m; i++)
+    if (rows[i] < GLP_BS || rows[i] > GLP_NS)
+      caml_invalid_argument("set_basis");
+  for(i = 0; i < n; i++)
+    if (cols[i] < GLP_BS || cols[i] > GLP_NS)
+      caml_invalid_argument("set_basis");
+  /* glpk adjusts non-basic statuses which do not match the bounds. */
+  for(i = 0; i < m; i++)
+    glp_set_row_stat(lp, i + 1, rows[i]);
+  for(i = 0; i < n; i++)
+    glp_set_col_stat(lp, i + 1, cols[i]);
+  return Val_unit;
+}
+
+CAMLprim value ocaml_glpk_get_num_rows(value blp)
+{
+  LPX *lp = Lpx_val(blp);
+  return Val_int(lpx_get_num_rows(lp));
+}
+
+CAMLprim value ocaml_glpk_get_num_cols(value blp)
+{
+  LPX *lp = Lpx_val(blp);
+  return Val_int(lpx_get_num_cols(lp));
+}
+
+CAMLprim value ocaml_glpk_scale_problem(value blp)
+{
+  LPX *lp = Lpx_val(blp);
+  lpx_scale_prob(lp, Cps_val(blp));
+  return Val_unit;
+}
+
+CAMLprim value ocaml_glpk_unscale_problem(value blp)
+{
+  LPX *lp = Lpx_val(blp);
+  lpx_unscale_prob(lp);
+  return Val_unit;
+}
+
+#define Table_size(t) (sizeof(t) / sizeof(int))
+
+static value val_of_table(int *table, int len, int x)
+{
+  int i;
+
+  for(i = 0; i < len; i++)
+    if (table[i] == x)
+      return Val_int(i);
+  assert(0);
+  return Val_int(0);
+}
+
+#define Val_table(t, x) val_of_table(t, Table_size(t), x)
+
+/* Statuses in the order of the status type. */
+static int status_table[] = {GLP_UNDEF, GLP_FEAS, GLP_INFEAS, GLP_NOFEAS, GLP_OPT, GLP_UNBND};
+
+CAMLprim value ocaml_glpk_get_status(value blp, value sol)
+{
+  LPX *lp = Lpx_val(blp);
+
+  return Val_table(status_table, Int_val(sol) == 0 ? glp_get_status(lp) : glp_mip_status(lp));
+}
+
+static value val_some(value v)
+{
+  CAMLparam1(v);
+  CAMLlocal1(ans);
+
+  ans = caml_alloc_small(1, 0);
+  Field(ans, 0) = v;
+  CAMLreturn(ans);
+}
+
+/* Index from 1 of the new API, 0 meaning none, as an optional index from 0. */
+static value val_index_opt(int i)
+{
+  return i > 0 ? val_some(Val_int(i - 1)) : Val_int(0);
+}
+
+static int quality_table[] = {'H', 'M', 'L', '?'};
+
+/* Result of a check of the KKT conditions: largest absolute and relative
+ * errors, where they are reached and quality. */
+static value val_kkt_check(double ae_max, int ae_ind, double re_max, int re_ind, int quality)
+{
+  CAMLparam0();
+  CAMLlocal2(ans, v);
+
+  ans = caml_alloc_tuple(5);
+  v = caml_copy_double(ae_max);
+  Store_field(ans, 0, v);
+  v = val_index_opt(ae_ind);
+  Store_field(ans, 1, v);
+  v = caml_copy_double(re_max);
+  Store_field(ans, 2, v);
+  v = val_index_opt(re_ind);
+  Store_field(ans, 3, v);
+  Store_field(ans, 4, Val_table(quality_table, quality));
+  CAMLreturn(ans);
+}
+
+CAMLprim value ocaml_glpk_check_kkt(value blp, value sol)
+{
+  CAMLparam2(blp, sol);
+  CAMLlocal2(ans, v);
+  LPX *lp = Lpx_val(blp);
+  LPXKKT kkt;
+  int mip = Int_val(sol) == 1;
+
+  caml_enter_blocking_section();
+  if (mip)
+    lpx_check_int(lp, &kkt);
+  else
+    lpx_check_kkt(lp, 0, &kkt);
+  caml_leave_blocking_section();
+
+  ans = caml_alloc_tuple(4);
+  v = val_kkt_check(kkt.pe_ae_max, kkt.pe_ae_row, kkt.pe_re_max, kkt.pe_re_row, kkt.pe_quality);
+  Store_field(ans, 0, v);
+  v = val_kkt_check(kkt.pb_ae_max, kkt.pb_ae_ind, kkt.pb_re_max, kkt.pb_re_ind, kkt.pb_quality);
+  Store_field(ans, 1, v);
+  if (mip)
+  {
+    /* Dual values are not defined for MIP solutions. */
+    Store_field(ans, 2, Val_int(0));
+    Store_field(ans, 3, Val_int(0));
+  }
+  else
+  {
+    v = val_kkt_check(kkt.de_ae_max, kkt.de_ae_col, kkt.de_re_max, kkt.de_re_col, kkt.de_quality);
+    Store_field(ans, 2, val_some(v));
+    v = val_kkt_check(kkt.db_ae_max, kkt.db_ae_ind, kkt.db_re_max, kkt.db_re_ind, kkt.db_quality);
+    Store_field(ans, 3, val_some(v));
+  }
+  CAMLreturn(ans);
+}
+
+CAMLprim value ocaml_glpk_interior(value blp)
+{
+  CAMLparam1(blp);
+  LPX *lp = Lpx_val(blp);
+  int ret;
+
+  caml_enter_blocking_section();
+  ret = lpx_interior(lp);
+  caml_leave_blocking_section();
+
+  raise_on_error(ret);
+  CAMLreturn(Val_unit);
+}
+
+static int class_table[] = {LPX_LP, LPX_MIP};
+
+CAMLprim value ocaml_glpk_set_class(value blp, value class)
 {
   LPX *lp = Lpx_val(blp);
   lpx_set_class(lp, class_table[Int_val(class)]);
@@ -434,10 +1796,12 @@ CAMLprim value ocaml_glpk_integer(value blp)
 {
   CAMLparam1(blp);
   LPX *lp = Lpx_val(blp);
+  /* The block might be moved by the GC during the blocking section. */
+  LPXCPS cps = *Cps_val(blp);
   int ret;
 
   caml_enter_blocking_section();
-  ret = lpx_integer(lp);
+  ret = lpx_integer(lp, &cps);
   caml_leave_blocking_section();
 
   raise_on_error(ret);
@@ -448,10 +1812,12 @@ CAMLprim value ocaml_glpk_intopt(value blp)
 {
   CAMLparam1(blp);
   LPX *lp = Lpx_val(blp);
+  /* The block might be moved by the GC during the blocking section. */
+  LPXCPS cps = *Cps_val(blp);
   int ret;
 
   caml_enter_blocking_section();
-  ret = lpx_intopt(lp);
+  ret = lpx_intopt(lp, &cps);
   caml_leave_blocking_section();
 
   raise_on_error(ret);
@@ -465,34 +1831,300 @@ CAMLprim value ocaml_glpk_warm_up(value blp)
   return Val_unit;
 }
 
-#define BIND_INT_PARAM(name, param) \
-CAMLprim value ocaml_glpk_get_##name(value blp) \
-{ \
-  LPX *lp = Lpx_val(blp); \
-  return Val_int(lpx_get_int_parm(lp, param)); \
-} \
-CAMLprim value ocaml_glpk_set_##name(value blp, value n) \
-{ \
-  LPX *lp = Lpx_val(blp); \
-  lpx_set_int_parm(lp, param, Int_val(n)); \
-  return Val_unit; \
-}
+static void (*initial_basis_table[])(LPX*) = {lpx_std_basis, lpx_adv_basis, lpx_cpx_basis};
 
-#define BIND_REAL_PARAM(name, param) \
-CAMLprim value ocaml_glpk_get_##name(value blp) \
-{ \
-  LPX *lp = Lpx_val(blp); \
-  double ans = lpx_get_real_parm(lp, param); \
-  return caml_copy_double(ans); \
-} \
-CAMLprim value ocaml_glpk_set_##name(value blp, value n) \
-{ \
-  LPX *lp = Lpx_val(blp); \
-  lpx_set_real_parm(lp, param, Double_val(n)); \
-  return Val_unit; \
-}
+CAMLprim value ocaml_glpk_build_basis(value blp, value basis)
+{
+  CAMLparam2(blp, basis);
+  LPX *lp = Lpx_val(blp);
+  void (*build)(LPX*) = initial_basis_table[Int_val(basis)];
 
-BIND_INT_PARAM(message_level, LPX_K_MSGLEV);
+  caml_enter_blocking_section();
+  build(lp);
+  caml_leave_blocking_section();
+
+  CAMLreturn(Val_unit);
+}
+
+/* Sensitivity analysis of rows (or columns) first to first+len-1, glpk
+ * numbering auxiliary variables before structural ones. */
+static void analyze_ranges(value blp, value vfirst, value vcols, value vlo, value vhi, int coef, const char *fname)
+{
+  LPX *lp = Lpx_val(blp);
+  int m = lpx_get_num_rows(lp);
+  int n = lpx_get_num_cols(lp);
+  int first = Int_val(vfirst);
+  int cols = Bool_val(vcols);
+  intnat len = Ba_len(vlo);
+  double *lo = (double*)Caml_ba_data_val(vlo);
+  double *hi = (double*)Caml_ba_data_val(vhi);
+  double value1, value2;
+  int var1, var2, k, i, ok = 1;
+
+  if (Ba_len(vhi) != len || first < 0 || first + len > (cols ? n : m))
+    caml_invalid_argument(fname);
+  if (glp_get_status(lp) != GLP_OPT)
+    caml_failwith("Sensitivity analysis requires an optimal basic solution.");
+
+  caml_enter_blocking_section();
+  /* The factorization is not available on copies of problems. */
+  if (!glp_bf_exists(lp))
+    ok = glp_factorize(lp) == 0;
+  for(i = 0; ok && i < len; i++)
+  {
+    k = (cols ? m : 0) + first + i + 1;
+    if (coef)
+      glp_analyze_coef(lp, k, &lo[i], &var1, &value1, &hi[i], &var2, &value2);
+    else if ((k <= m ? glp_get_row_stat(lp, k) : glp_get_col_stat(lp, k - m)) == GLP_BS)
+      lo[i] = hi[i] = NAN;
+    else
+      glp_analyze_bound(lp, k, &lo[i], &var1, &hi[i], &var2);
+    if (lo[i] <= -DBL_MAX)
+      lo[i] = -INFINITY;
+    if (hi[i] >= DBL_MAX)
+      hi[i] = INFINITY;
+  }
+  caml_leave_blocking_section();
+
+  if (!ok)
+    raise_on_error(LPX_E_SING);
+}
+
+CAMLprim value ocaml_glpk_bound_ranges(value blp, value first, value cols, value lo, value hi)
+{
+  CAMLparam5(blp, first, cols, lo, hi);
+  analyze_ranges(blp, first, cols, lo, hi, 0, "bound_ranges");
+  CAMLreturn(Val_unit);
+}
+
+CAMLprim value ocaml_glpk_cost_ranges(value blp, value first, value cols, value lo, value hi)
+{
+  CAMLparam5(blp, first, cols, lo, hi);
+  analyze_ranges(blp, first, cols, lo, hi, 1, "cost_ranges");
+  CAMLreturn(Val_unit);
+}
+
+/* Simplex tableau and basis matrix. Variables are numbered from 0, auxiliary
+ * variables (rows) coming before structural ones (columns), and vectors of
+ * indexes of variables are handed to glpk after being shifted in place. */
+
+/* Make sure that the factorization of the basis matrix is available. */
+static void need_factorization(LPX *lp)
+{
+  if (!glp_bf_exists(lp) && glp_factorize(lp) != 0)
+    raise_on_error(LPX_E_BADB);
+}
+
+static int var_stat(LPX *lp, int k)
+{
+  int m = lpx_get_num_rows(lp);
+
+  return k <= m ? glp_get_row_stat(lp, k) : glp_get_col_stat(lp, k - m);
+}
+
+static int tab_var_val(LPX *lp, value vk, int basic, const char *fname)
+{
+  int k = Int_val(vk) + 1;
+
+  if (k < 1 || k > lpx_get_num_rows(lp) + lpx_get_num_cols(lp))
+    caml_invalid_argument(fname);
+  if ((var_stat(lp, k) == GLP_BS) != basic)
+    caml_invalid_argument(fname);
+  return k;
+}
+
+static void check_tab_vectors(value vind, value vval, intnat len, const char *fname)
+{
+  if (Ba_len(vind) < len || Ba_len(vval) < len)
+    caml_invalid_argument(fname);
+}
+
+CAMLprim value ocaml_glpk_eval_tab_row(value blp, value vk, value vind, value vval)
+{
+  LPX *lp = Lpx_val(blp);
+  int *ind = (int*)Caml_ba_data_val(vind);
+  double *val = (double*)Caml_ba_data_val(vval);
+  int k = tab_var_val(lp, vk, 1, "eval_tab_row");
+  int len;
+
+  check_tab_vectors(vind, vval, lpx_get_num_cols(lp), "eval_tab_row");
+  need_factorization(lp);
+  len = lpx_eval_tab_row(lp, k, ind - 1, val - 1);
+  shift_indices(ind, len, -1);
+  return Val_int(len);
+}
+
+CAMLprim value ocaml_glpk_eval_tab_col(value blp, value vk, value vind, value vval)
+{
+  LPX *lp = Lpx_val(blp);
+  int *ind = (int*)Caml_ba_data_val(vind);
+  double *val = (double*)Caml_ba_data_val(vval);
+  int k = tab_var_val(lp, vk, 0, "eval_tab_col");
+  int len;
+
+  check_tab_vectors(vind, vval, lpx_get_num_rows(lp), "eval_tab_col");
+  need_factorization(lp);
+  len = lpx_eval_tab_col(lp, k, ind - 1, val - 1);
+  shift_indices(ind, len, -1);
+  return Val_int(len);
+}
+
+/* Express a row (or column) given in terms of the columns (or rows) as a
+ * combination of non-basic (or basic) variables. */
+static int transform_vector(LPX *lp, value vlen, value vind, value vval, int by_row, const char *fname)
+{
+  int *ind = (int*)Caml_ba_data_val(vind);
+  double *val = (double*)Caml_ba_data_val(vval);
+  int dim = by_row ? lpx_get_num_cols(lp) : lpx_get_num_rows(lp);
+  int len = Int_val(vlen);
+  int *work;
+  int ok;
+
+  check_tab_vectors(vind, vval, dim, fname);
+  if (len < 0 || len > dim)
+    caml_invalid_argument(fname);
+  work = (int*)malloc((len + 1) * sizeof(int));
+  if (!work)
+    caml_raise_out_of_memory();
+  shift_indices(ind, len, 1);
+  ok = distinct_indices(ind - 1, len, dim, work);
+  free(work);
+  if (!ok)
+  {
+    shift_indices(ind, len, -1);
+    caml_invalid_argument(fname);
+  }
+  need_factorization(lp);
+  if (by_row)
+    len = lpx_transform_row(lp, len, ind - 1, val - 1);
+  else
+    len = lpx_transform_col(lp, len, ind - 1, val - 1);
+  shift_indices(ind, len, -1);
+  return len;
+}
+
+CAMLprim value ocaml_glpk_transform_row(value blp, value len, value ind, value val)
+{
+  return Val_int(transform_vector(Lpx_val(blp), len, ind, val, 1, "transform_row"));
+}
+
+CAMLprim value ocaml_glpk_transform_col(value blp, value len, value ind, value val)
+{
+  return Val_int(transform_vector(Lpx_val(blp), len, ind, val, 0, "transform_col"));
+}
+
+/* Ratio test on the first len elements of a row (or column) of the tableau,
+ * whose variables should all be basic (or non-basic). */
+static value ratio_test(LPX *lp, value vlen, value vind, value vval, value vincr, value veps, int primal, const char *fname)
+{
+  CAMLparam0();
+  CAMLlocal1(ans);
+  int *ind = (int*)Caml_ba_data_val(vind);
+  double *val = (double*)Caml_ba_data_val(vval);
+  int len = Int_val(vlen);
+  int n = lpx_get_num_rows(lp) + lpx_get_num_cols(lp);
+  int *ind1;
+  int i, k;
+
+  if (len < 0 || len > Ba_len(vind) || len > Ba_len(vval) || Double_val(veps) < 0)
+    caml_invalid_argument(fname);
+  for(i = 0; i < len; i++)
+    if (ind[i] < 0 || ind[i] >= n || (var_stat(lp, ind[i] + 1) == GLP_BS) != primal)
+      caml_invalid_argument(fname);
+  if ((primal ? glp_get_prim_stat(lp) : glp_get_dual_stat(lp)) != GLP_FEAS)
+    caml_failwith(primal ? "Primal ratio test requires a primal feasible basic solution." : "Dual ratio test requires a dual feasible basic solution.");
+
+  /* The indexes are only read, so that they are copied. */
+  ind1 = one_based_indices(ind, len);
+  if (!ind1)
+    caml_raise_out_of_memory();
+  if (primal)
+    k = lpx_prim_ratio_test(lp, len, ind1, val - 1, Bool_val(vincr) ? 1 : -1, Double_val(veps));
+  else
+    k = lpx_dual_ratio_test(lp, len, ind1, val - 1, Bool_val(vincr) ? 1 : -1, Double_val(veps));
+  free(ind1);
+
+  if (k == 0)
+    CAMLreturn(Val_int(0));
+  ans = caml_alloc_small(1, 0);
+  Field(ans, 0) = Val_int(k - 1);
+  CAMLreturn(ans);
+}
+
+CAMLprim value ocaml_glpk_prim_ratio_test(value blp, value len, value ind, value val, value incr, value eps)
+{
+  return ratio_test(Lpx_val(blp), len, ind, val, incr, eps, 1, "prim_ratio_test");
+}
+
+CAMLprim value ocaml_glpk_prim_ratio_test_bytecode(value *argv, int argn)
+{
+  return ocaml_glpk_prim_ratio_test(argv[0], argv[1], argv[2], argv[3], argv[4], argv[5]);
+}
+
+CAMLprim value ocaml_glpk_dual_ratio_test(value blp, value len, value ind, value val, value incr, value eps)
+{
+  return ratio_test(Lpx_val(blp), len, ind, val, incr, eps, 0, "dual_ratio_test");
+}
+
+CAMLprim value ocaml_glpk_dual_ratio_test_bytecode(value *argv, int argn)
+{
+  return ocaml_glpk_dual_ratio_test(argv[0], argv[1], argv[2], argv[3], argv[4], argv[5]);
+}
+
+/* Solve B x = b (or B' x = b) in place. */
+static void solve_basis(LPX *lp, value vx, int transposed, const char *fname)
+{
+  double *x = (double*)Caml_ba_data_val(vx);
+
+  if (Ba_len(vx) != lpx_get_num_rows(lp))
+    caml_invalid_argument(fname);
+  need_factorization(lp);
+  if (transposed)
+    glp_btran(lp, x - 1);
+  else
+    glp_ftran(lp, x - 1);
+}
+
+CAMLprim value ocaml_glpk_ftran(value blp, value x)
+{
+  solve_basis(Lpx_val(blp), x, 0, "ftran");
+  return Val_unit;
+}
+
+CAMLprim value ocaml_glpk_btran(value blp, value x)
+{
+  solve_basis(Lpx_val(blp), x, 1, "btran");
+  return Val_unit;
+}
+
+#define BIND_INT_PARAM(name, param) \
+CAMLprim value ocaml_glpk_get_##name(value blp) \
+{ \
+  LPX *lp = Lpx_val(blp); \
+  return Val_int(lpx_get_int_parm(lp, Cps_val(blp), param)); \
+} \
+CAMLprim value ocaml_glpk_set_##name(value blp, value n) \
+{ \
+  LPX *lp = Lpx_val(blp); \
+  lpx_set_int_parm(lp, Cps_val(blp), param, Int_val(n)); \
+  return Val_unit; \
+}
+
+#define BIND_REAL_PARAM(name, param) \
+CAMLprim value ocaml_glpk_get_##name(value blp) \
+{ \
+  LPX *lp = Lpx_val(blp); \
+  double ans = lpx_get_real_parm(lp, Cps_val(blp), param); \
+  return caml_copy_double(ans); \
+} \
+CAMLprim value ocaml_glpk_set_##name(value blp, value n) \
+{ \
+  LPX *lp = Lpx_val(blp); \
+  lpx_set_real_parm(lp, Cps_val(blp), param, Double_val(n)); \
+  return Val_unit; \
+}
+
+BIND_INT_PARAM(message_level, LPX_K_MSGLEV);
 BIND_INT_PARAM(scaling, LPX_K_SCALE);
 BIND_INT_PARAM(use_dual_simplex, LPX_K_DUAL);
 BIND_INT_PARAM(pricing, LPX_K_PRICE);
@@ -508,6 +2140,737 @@ BIND_REAL_PARAM(time_limit, LPX_K_TMLIM);
 BIND_INT_PARAM(branching_heuristic, LPX_K_BRANCH);
 BIND_INT_PARAM(backtracking_heuristic, LPX_K_BTRACK);
 BIND_INT_PARAM(use_presolver, LPX_K_PRESOL);
+BIND_INT_PARAM(binarization, LPX_K_BINARIZE);
+BIND_INT_PARAM(cuts, LPX_K_USECUTS);
+BIND_REAL_PARAM(mip_gap, LPX_K_MIPGAP);
+
+/* Typed solver parameters: the tables give the constants corresponding to the
+ * constructors of the variants of glpk.ml, and the functions below convert
+ * the records to the control parameter structures of glpk and back. */
+
+static int msg_level_table[] = {GLP_MSG_OFF, GLP_MSG_ERR, GLP_MSG_ON, GLP_MSG_ALL};
+static int meth_table[] = {GLP_PRIMAL, GLP_DUALP, GLP_DUAL};
+static int pricing_table[] = {GLP_PT_STD, GLP_PT_PSE};
+static int ratio_test_table[] = {GLP_RT_STD, GLP_RT_HAR};
+static int ordering_table[] = {GLP_ORD_NONE, GLP_ORD_QMD, GLP_ORD_AMD, GLP_ORD_SYMAMD};
+static int branching_table[] = {GLP_BR_FFV, GLP_BR_LFV, GLP_BR_MFV, GLP_BR_DTH, GLP_BR_PCH};
+static int backtracking_table[] = {GLP_BT_DFS, GLP_BT_BFS, GLP_BT_BLB, GLP_BT_BPH};
+static int preprocessing_table[] = {GLP_PP_NONE, GLP_PP_ROOT, GLP_PP_ALL};
+
+/* Limits: glpk uses INT_MAX and DBL_MAX where we use max_int and infinity,
+ * and milliseconds where we use seconds. */
+
+static int int_limit_val(value v)
+{
+  intnat n = Long_val(v);
+  return (n < 0 || n > INT_MAX) ? INT_MAX : n;
+}
+
+static value val_int_limit(int n)
+{
+  return n == INT_MAX ? Val_long(Max_long) : Val_int(n);
+}
+
+static int ms_limit_val(value v)
+{
+  double t = Double_val(v);
+  return (t < 0 || 1000. * t >= INT_MAX) ? INT_MAX : (int)(1000. * t);
+}
+
+static value val_ms_limit(int ms)
+{
+  return caml_copy_double(ms == INT_MAX ? INFINITY : ms / 1000.);
+}
+
+static double real_limit_val(value v)
+{
+  double x = Double_val(v);
+  return isinf(x) ? (x > 0 ? DBL_MAX : -DBL_MAX) : x;
+}
+
+static value val_real_limit(double x)
+{
+  return caml_copy_double(x >= DBL_MAX ? INFINITY : x <= -DBL_MAX ? -INFINITY : x);
+}
+
+static void smcp_val(value v, glp_smcp *parm)
+{
+  glp_init_smcp(parm);
+  parm->msg_lev = msg_level_table[Int_val(Field(v, 0))];
+  parm->meth = meth_table[Int_val(Field(v, 1))];
+  parm->pricing = pricing_table[Int_val(Field(v, 2))];
+  parm->r_test = ratio_test_table[Int_val(Field(v, 3))];
+  parm->tol_bnd = Double_val(Field(v, 4));
+  parm->tol_dj = Double_val(Field(v, 5));
+  parm->tol_piv = Double_val(Field(v, 6));
+  parm->obj_ll = real_limit_val(Field(v, 7));
+  parm->obj_ul = real_limit_val(Field(v, 8));
+  parm->it_lim = int_limit_val(Field(v, 9));
+  parm->tm_lim = ms_limit_val(Field(v, 10));
+  parm->out_frq = Int_val(Field(v, 11));
+  parm->out_dly = ms_limit_val(Field(v, 12));
+  parm->presolve = Bool_val(Field(v, 13)) ? GLP_ON : GLP_OFF;
+}
+
+static void iptcp_val(value v, glp_iptcp *parm)
+{
+  glp_init_iptcp(parm);
+  parm->msg_lev = msg_level_table[Int_val(Field(v, 0))];
+  parm->ord_alg = ordering_table[Int_val(Field(v, 1))];
+}
+
+static void iocp_val(value v, glp_iocp *parm)
+{
+  glp_init_iocp(parm);
+  parm->msg_lev = msg_level_table[Int_val(Field(v, 0))];
+  parm->br_tech = branching_table[Int_val(Field(v, 1))];
+  parm->bt_tech = backtracking_table[Int_val(Field(v, 2))];
+  parm->pp_tech = preprocessing_table[Int_val(Field(v, 3))];
+  parm->tol_int = Double_val(Field(v, 4));
+  parm->tol_obj = Double_val(Field(v, 5));
+  parm->mip_gap = Double_val(Field(v, 6));
+  parm->tm_lim = ms_limit_val(Field(v, 7));
+  parm->out_frq = ms_limit_val(Field(v, 8));
+  parm->out_dly = ms_limit_val(Field(v, 9));
+  parm->presolve = Bool_val(Field(v, 10)) ? GLP_ON : GLP_OFF;
+  parm->binarize = Bool_val(Field(v, 11)) ? GLP_ON : GLP_OFF;
+  parm->gmi_cuts = Bool_val(Field(v, 12)) ? GLP_ON : GLP_OFF;
+  parm->mir_cuts = Bool_val(Field(v, 13)) ? GLP_ON : GLP_OFF;
+  parm->cov_cuts = Bool_val(Field(v, 14)) ? GLP_ON : GLP_OFF;
+  parm->clq_cuts = Bool_val(Field(v, 15)) ? GLP_ON : GLP_OFF;
+  parm->fp_heur = Bool_val(Field(v, 16)) ? GLP_ON : GLP_OFF;
+}
+
+CAMLprim value ocaml_glpk_default_simplex_params(value unit)
+{
+  CAMLparam0();
+  CAMLlocal1(ans);
+  glp_smcp parm;
+
+  glp_init_smcp(&parm);
+  ans = caml_alloc_tuple(14);
+  Store_field(ans, 0, Val_table(msg_level_table, parm.msg_lev));
+  Store_field(ans, 1, Val_table(meth_table, parm.meth));
+  Store_field(ans, 2, Val_table(pricing_table, parm.pricing));
+  Store_field(ans, 3, Val_table(ratio_test_table, parm.r_test));
+  Store_field(ans, 4, caml_copy_double(parm.tol_bnd));
+  Store_field(ans, 5, caml_copy_double(parm.tol_dj));
+  Store_field(ans, 6, caml_copy_double(parm.tol_piv));
+  Store_field(ans, 7, val_real_limit(parm.obj_ll));
+  Store_field(ans, 8, val_real_limit(parm.obj_ul));
+  Store_field(ans, 9, val_int_limit(parm.it_lim));
+  Store_field(ans, 10, val_ms_limit(parm.tm_lim));
+  Store_field(ans, 11, Val_int(parm.out_frq));
+  Store_field(ans, 12, val_ms_limit(parm.out_dly));
+  Store_field(ans, 13, Val_bool(parm.presolve == GLP_ON));
+  CAMLreturn(ans);
+}
+
+CAMLprim value ocaml_glpk_default_interior_params(value unit)
+{
+  CAMLparam0();
+  CAMLlocal1(ans);
+  glp_iptcp parm;
+
+  glp_init_iptcp(&parm);
+  ans = caml_alloc_tuple(2);
+  Store_field(ans, 0, Val_table(msg_level_table, parm.msg_lev));
+  Store_field(ans, 1, Val_table(ordering_table, parm.ord_alg));
+  CAMLreturn(ans);
+}
+
+CAMLprim value ocaml_glpk_default_mip_params(value unit)
+{
+  CAMLparam0();
+  CAMLlocal1(ans);
+  glp_iocp parm;
+
+  glp_init_iocp(&parm);
+  ans = caml_alloc_tuple(17);
+  Store_field(ans, 0, Val_table(msg_level_table, parm.msg_lev));
+  Store_field(ans, 1, Val_table(branching_table, parm.br_tech));
+  Store_field(ans, 2, Val_table(backtracking_table, parm.bt_tech));
+  Store_field(ans, 3, Val_table(preprocessing_table, parm.pp_tech));
+  Store_field(ans, 4, caml_copy_double(parm.tol_int));
+  Store_field(ans, 5, caml_copy_double(parm.tol_obj));
+  Store_field(ans, 6, caml_copy_double(parm.mip_gap));
+  Store_field(ans, 7, val_ms_limit(parm.tm_lim));
+  Store_field(ans, 8, val_ms_limit(parm.out_frq));
+  Store_field(ans, 9, val_ms_limit(parm.out_dly));
+  Store_field(ans, 10, Val_bool(parm.presolve == GLP_ON));
+  Store_field(ans, 11, Val_bool(parm.binarize == GLP_ON));
+  Store_field(ans, 12, Val_bool(parm.gmi_cuts == GLP_ON));
+  Store_field(ans, 13, Val_bool(parm.mir_cuts == GLP_ON));
+  Store_field(ans, 14, Val_bool(parm.cov_cuts == GLP_ON));
+  Store_field(ans, 15, Val_bool(parm.clq_cuts == GLP_ON));
+  Store_field(ans, 16, Val_bool(parm.fp_heur == GLP_ON));
+  CAMLreturn(ans);
+}
+
+/* Cancellation tokens: a flag which can be set by any thread and is checked
+ * by the solvers. It is allocated outside of the OCaml heap so that it does not
+ * move during the solving. */
+typedef struct
+{
+  int cancelled;
+} cancel_token;
+
+#define Cancel_val(v) (*((cancel_token**)Data_custom_val(v)))
+
+/* Token of an optional argument, or NULL. */
+#define Cancel_opt_val(v) (Is_block(v) ? Cancel_val(Field(v, 0)) : NULL)
+
+static void finalize_cancel(value v)
+{
+  free(Cancel_val(v));
+}
+
+static struct custom_operations cancel_ops =
+{
+  "ocaml_glpk_cancel_token",
+  finalize_cancel,
+  custom_compare_default,
+  custom_hash_default,
+  custom_serialize_default,
+  custom_deserialize_default
+};
+
+CAMLprim value ocaml_glpk_new_cancel_token(value unit)
+{
+  cancel_token *t = malloc(sizeof(cancel_token));
+  value ans;
+
+  if (!t)
+    caml_raise_out_of_memory();
+  t->cancelled = 0;
+  ans = caml_alloc_custom(&cancel_ops, sizeof(cancel_token*), 0, 1);
+  Cancel_val(ans) = t;
+  return ans;
+}
+
+CAMLprim value ocaml_glpk_cancel(value v)
+{
+  __atomic_store_n(&Cancel_val(v)->cancelled, 1, __ATOMIC_RELEASE);
+  return Val_unit;
+}
+
+static int is_cancelled(cancel_token *t)
+{
+  return t && __atomic_load_n(&t->cancelled, __ATOMIC_ACQUIRE);
+}
+
+CAMLprim value ocaml_glpk_is_cancelled(value v)
+{
+  return Val_bool(is_cancelled(Cancel_val(v)));
+}
+
+/* Time between two checks of the cancellation token, in milliseconds: it starts
+ * at CANCEL_CHECK_MIN and doubles after each check up to CANCEL_CHECK_MAX. */
+#define CANCEL_CHECK_MIN 100
+#define CANCEL_CHECK_MAX 2000
+
+/* glp_simplex cannot be interrupted, so when a cancellation token is given we
+ * run it by chunks of time and check the token in between, the simplex
+ * resuming from the current basis. Each restart rebuilds the working problem
+ * and the factorization of glpk and loses its pricing weights, which is why
+ * the chunks are long and grow, so that the overhead stays small compared to
+ * the time spent in iterations. This is not possible with the presolver,
+ * since it does not provide a basis for the original problem when stopped, in
+ * which case the token is only checked before starting. */
+static int simplex_cancellable(LPX *lp, glp_smcp *parm, cancel_token *t)
+{
+  int it_lim = parm->it_lim;
+  int tm_lim = parm->tm_lim;
+  int chunk = CANCEL_CHECK_MIN;
+  double start = glp_time();
+  int it_cnt, remaining, ret;
+
+  if (is_cancelled(t))
+    return GLP_ESTOP;
+  if (!t || parm->presolve == GLP_ON)
+    return glp_simplex(lp, parm);
+
+  while (1)
+  {
+    remaining = INT_MAX;
+    if (tm_lim != INT_MAX)
+      remaining = tm_lim - (int)(glp_difftime(glp_time(), start) * 1000);
+    if (remaining <= 0)
+      return GLP_ETMLIM;
+    parm->tm_lim = remaining < chunk ? remaining : chunk;
+    parm->it_lim = it_lim;
+    it_cnt = glp_get_it_cnt(lp);
+    ret = glp_simplex(lp, parm);
+    if (ret != GLP_ETMLIM)
+      return ret;
+    if (parm->tm_lim == remaining)
+      return GLP_ETMLIM;
+    if (it_lim != INT_MAX)
+      it_lim -= glp_get_it_cnt(lp) - it_cnt;
+    if (is_cancelled(t))
+      return GLP_ESTOP;
+    if (chunk < CANCEL_CHECK_MAX)
+      chunk *= 2;
+  }
+}
+
+/* Progress of the branch-and-cut solver: samples are written by the solving
+ * thread in a ring buffer and read by the polling thread. The writer never
+ * waits: when the buffer is full, the oldest samples are overwritten and the
+ * reader drops the samples which could have been overwritten while copied. */
+typedef struct
+{
+  double elapsed;
+  int nodes;
+  int active;
+  double bound;
+  double incumbent;
+  double gap;
+} progress_sample;
+
+typedef struct
+{
+  progress_sample *samples;
+  unsigned long capacity;
+  unsigned long head; /* number of samples written, only set by the writer */
+  unsigned long writing; /* number of samples written once the sample being
+                            written is complete, only set by the writer */
+  unsigned long tail; /* number of samples read, only used by the reader (it
+                         is not atomic, so that there must be one reader) */
+  double interval;    /* minimal time between two periodic samples, in seconds */
+  double start;
+  double last;
+} progress;
+
+#define Progress_val(v) (*((progress**)Data_custom_val(v)))
+
+#define Progress_opt_val(v) (Is_block(v) ? Progress_val(Field(v, 0)) : NULL)
+
+static void finalize_progress(value v)
+{
+  progress *p = Progress_val(v);
+
+  free(p->samples);
+  free(p);
+}
+
+static struct custom_operations progress_ops =
+{
+  "ocaml_glpk_progress",
+  finalize_progress,
+  custom_compare_default,
+  custom_hash_default,
+  custom_serialize_default,
+  custom_deserialize_default
+};
+
+CAMLprim value ocaml_glpk_new_progress(value vcapacity, value vinterval)
+{
+  intnat capacity = Long_val(vcapacity);
+  progress *p;
+  value ans;
+
+  if (capacity <= 0 || Double_val(vinterval) < 0)
+    caml_invalid_argument("new_progress");
+  p = malloc(sizeof(progress));
+  if (!p)
+    caml_raise_out_of_memory();
+  p->samples = malloc(capacity * sizeof(progress_sample));
+  if (!p->samples)
+  {
+    free(p);
+    caml_raise_out_of_memory();
+  }
+  p->capacity = capacity;
+  p->head = 0;
+  p->writing = 0;
+  p->tail = 0;
+  p->interval = Double_val(vinterval);
+  p->start = p->last = 0;
+  ans = caml_alloc_custom(&progress_ops, sizeof(progress*), 0, 1);
+  Progress_val(ans) = p;
+  return ans;
+}
+
+static void progress_start(progress *p)
+{
+  p->start = glp_time();
+  p->last = -p->interval;
+}
+
+static void progress_record(progress *p, glp_tree *T, int force)
+{
+  glp_prob *lp = glp_ios_get_prob(T);
+  double elapsed = glp_difftime(glp_time(), p->start);
+  unsigned long head = p->head;
+  progress_sample *s;
+  int a_cnt, n_cnt, t_cnt, best;
+
+  if (!force && elapsed - p->last < p->interval)
+    return;
+  p->last = elapsed;
+  /* Announce the slot which is going to be overwritten (the one of the sample
+   * numbered head - capacity) before writing it, so that the reader can drop
+   * it. */
+  __atomic_store_n(&p->writing, head + 1, __ATOMIC_RELAXED);
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+  s = &p->samples[head % p->capacity];
+  glp_ios_tree_size(T, &a_cnt, &n_cnt, &t_cnt);
+  best = glp_ios_best_node(T);
+  s->elapsed = elapsed;
+  s->nodes = t_cnt;
+  s->active = a_cnt;
+  s->incumbent = glp_mip_status(lp) == GLP_FEAS ? glp_mip_obj_val(lp) : NAN;
+  s->bound = best ? glp_ios_node_bound(T, best) : s->incumbent;
+  s->gap = glp_ios_mip_gap(T);
+  if (s->gap == DBL_MAX)
+    s->gap = INFINITY;
+  __atomic_store_n(&p->head, head + 1, __ATOMIC_RELEASE);
+}
+
+CAMLprim value ocaml_glpk_poll_progress(value vp)
+{
+  CAMLparam1(vp);
+  CAMLlocal2(ans, sample);
+  progress *p = Progress_val(vp);
+  progress_sample *buf;
+  unsigned long head, tail, writing, n, i, j;
+
+  head = __atomic_load_n(&p->head, __ATOMIC_ACQUIRE);
+  tail = p->tail;
+  if (head - tail > p->capacity)
+    tail = head - p->capacity;
+  n = head - tail;
+  buf = malloc((n ? n : 1) * sizeof(progress_sample));
+  if (!buf)
+    caml_raise_out_of_memory();
+  for (i = 0; i < n; i++)
+    buf[i] = p->samples[(tail + i) % p->capacity];
+  /* Samples which were overwritten during the copy, or are being
+   * overwritten, are dropped. */
+  __atomic_thread_fence(__ATOMIC_ACQUIRE);
+  writing = __atomic_load_n(&p->writing, __ATOMIC_RELAXED);
+  i = writing - tail > p->capacity ? writing - tail - p->capacity : 0;
+  if (i > n)
+    i = n;
+  p->tail = tail + n;
+
+  ans = caml_alloc_tuple(n - i);
+  for (j = 0; i + j < n; j++)
+  {
+    progress_sample *s = &buf[i + j];
+
+    sample = caml_alloc_tuple(6);
+    Store_field(sample, 0, caml_copy_double(s->elapsed));
+    Store_field(sample, 1, Val_int(s->nodes));
+    Store_field(sample, 2, Val_int(s->active));
+    Store_field(sample, 3, caml_copy_double(s->bound));
+    Store_field(sample, 4, caml_copy_double(s->incumbent));
+    Store_field(sample, 5, caml_copy_double(s->gap));
+    Store_field(ans, j, sample);
+  }
+  free(buf);
+
+  CAMLreturn(ans);
+}
+
+/* Output of glpk, captured by a terminal hook in a ring buffer instead of being
+ * printed. The hook is set in the environment of a thread, so that it only
+ * captures the output of this thread. As for progress, the writer never waits
+ * and the oldest output is overwritten when the buffer is full. There must be
+ * at most one writer (the thread in which the log is installed) and one reader
+ * at a time: installing a log in a second thread is refused. */
+typedef struct
+{
+  char *data;
+  unsigned long capacity;
+  unsigned long head;    /* number of bytes written, only set by the writer */
+  unsigned long writing; /* number of bytes written once the message being
+                            written is complete, only set by the writer */
+  unsigned long tail;    /* number of bytes read, only used by the reader */
+  /* The following fields are protected by log_lock. */
+  int refcount;          /* number of OCaml values and hooks using the log */
+  int hooks;             /* number of times the log is installed */
+  pthread_t writer;      /* thread in which the log is installed */
+} log_buffer;
+
+static pthread_mutex_t log_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/* The log installed in the current thread. */
+static __thread log_buffer *current_log = NULL;
+
+#define Log_val(v) (*((log_buffer**)Data_custom_val(v)))
+
+static void log_release(log_buffer *l)
+{
+  int refcount;
+
+  pthread_mutex_lock(&log_lock);
+  refcount = --l->refcount;
+  pthread_mutex_unlock(&log_lock);
+  if (refcount == 0)
+  {
+    free(l->data);
+    free(l);
+  }
+}
+
+/* Uninstall the log of the current thread, if any, dropping the reference held
+ * by the hook. This does not use the runtime, so that it can be called when the
+ * thread exits. */
+static void release_current_log(void)
+{
+  log_buffer *l = current_log;
+
+  if (l)
+  {
+    current_log = NULL;
+    pthread_mutex_lock(&log_lock);
+    l->hooks--;
+    pthread_mutex_unlock(&log_lock);
+    log_release(l);
+  }
+}
+
+/* The buffer is only freed once it is not installed anymore. */
+static void finalize_log(value v)
+{
+  log_release(Log_val(v));
+}
+
+static struct custom_operations log_ops =
+{
+  "ocaml_glpk_log",
+  finalize_log,
+  custom_compare_default,
+  custom_hash_default,
+  custom_serialize_default,
+  custom_deserialize_default
+};
+
+static value alloc_log(log_buffer *l)
+{
+  value ans = caml_alloc_custom(&log_ops, sizeof(log_buffer*), 0, 1);
+
+  Log_val(ans) = l;
+  return ans;
+}
+
+CAMLprim value ocaml_glpk_new_log(value vcapacity)
+{
+  intnat capacity = Long_val(vcapacity);
+  log_buffer *l;
+
+  if (capacity <= 0)
+    caml_invalid_argument("new_log");
+  l = malloc(sizeof(log_buffer));
+  if (!l)
+    caml_raise_out_of_memory();
+  l->data = malloc(capacity);
+  if (!l->data)
+  {
+    free(l);
+    caml_raise_out_of_memory();
+  }
+  l->capacity = capacity;
+  l->head = 0;
+  l->writing = 0;
+  l->tail = 0;
+  l->refcount = 1;
+  l->hooks = 0;
+  return alloc_log(l);
+}
+
+static int log_hook(void *info, const char *s)
+{
+  log_buffer *l = (log_buffer*)info;
+  unsigned long head = l->head;
+  unsigned long len = strlen(s);
+  unsigned long end = head + len;
+
+  /* Announce the bytes which are going to be overwritten before writing
+   * them, so that the reader can drop them. */
+  __atomic_store_n(&l->writing, end, __ATOMIC_RELAXED);
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+  /* Only the end of a message longer than the buffer is kept. */
+  if (len > l->capacity)
+  {
+    s += len - l->capacity;
+    head = end - l->capacity;
+  }
+  for(; *s; s++, head++)
+    l->data[head % l->capacity] = *s;
+  __atomic_store_n(&l->head, end, __ATOMIC_RELEASE);
+  /* Do not print the output. */
+  return 1;
+}
+
+/* Install a log (or none) in the current thread and return the previous one. */
+CAMLprim value ocaml_glpk_set_log(value vlog)
+{
+  CAMLparam1(vlog);
+  CAMLlocal2(ans, prev);
+  log_buffer *l = Is_block(vlog) ? Log_val(Field(vlog, 0)) : NULL;
+  log_buffer *old = current_log;
+  pthread_t self = pthread_self();
+
+  if (l)
+  {
+    /* The environment makes sure that the log is released when the thread
+     * exits. */
+    if (!get_env())
+      caml_raise_out_of_memory();
+    pthread_mutex_lock(&log_lock);
+    if (l->hooks > 0 && !pthread_equal(l->writer, self))
+    {
+      pthread_mutex_unlock(&log_lock);
+      caml_invalid_argument("with_log: the log is used in another thread");
+    }
+    l->hooks++;
+    l->writer = self;
+    l->refcount++;
+    pthread_mutex_unlock(&log_lock);
+  }
+  ans = Val_int(0);
+  if (old)
+  {
+    /* The reference held by the hook is transferred to the returned value. */
+    pthread_mutex_lock(&log_lock);
+    old->hooks--;
+    pthread_mutex_unlock(&log_lock);
+    prev = alloc_log(old);
+    ans = val_some(prev);
+  }
+  current_log = l;
+  if (l)
+    glp_term_hook(log_hook, l);
+  else
+    glp_term_hook(NULL, NULL);
+  CAMLreturn(ans);
+}
+
+CAMLprim value ocaml_glpk_read_log(value vlog)
+{
+  CAMLparam1(vlog);
+  CAMLlocal1(ans);
+  log_buffer *l = Log_val(vlog);
+  unsigned long head, tail, writing, n, skip, i;
+  char *buf;
+
+  head = __atomic_load_n(&l->head, __ATOMIC_ACQUIRE);
+  tail = l->tail;
+  if (head - tail > l->capacity)
+    tail = head - l->capacity;
+  n = head - tail;
+  buf = malloc(n ? n : 1);
+  if (!buf)
+    caml_raise_out_of_memory();
+  for(i = 0; i < n; i++)
+    buf[i] = l->data[(tail + i) % l->capacity];
+  /* Bytes which were overwritten during the copy, or are being overwritten,
+   * are dropped. */
+  __atomic_thread_fence(__ATOMIC_ACQUIRE);
+  writing = __atomic_load_n(&l->writing, __ATOMIC_RELAXED);
+  skip = writing - tail > l->capacity ? writing - tail - l->capacity : 0;
+  if (skip > n)
+    skip = n;
+  l->tail = tail + n;
+
+  ans = caml_alloc_string(n - skip);
+  memcpy((char*)String_val(ans), buf + skip, n - skip);
+  free(buf);
+  CAMLreturn(ans);
+}
+
+/* Data passed to the callback of the branch-and-cut solver. */
+typedef struct
+{
+  cancel_token *cancel;
+  progress *progress;
+} mip_callback_info;
+
+static void mip_callback(glp_tree *T, void *info)
+{
+  mip_callback_info *mci = (mip_callback_info*)info;
+
+  if (mci->progress)
+  {
+    switch (glp_ios_reason(T))
+    {
+      case GLP_IBINGO:
+        progress_record(mci->progress, T, 1);
+        break;
+
+      case GLP_ISELECT:
+        progress_record(mci->progress, T, 0);
+        break;
+    }
+  }
+  if (is_cancelled(mci->cancel))
+    glp_ios_terminate(T);
+}
+
+CAMLprim value ocaml_glpk_simplex_with_params(value blp, value params, value vcancel, value vbasis)
+{
+  CAMLparam4(blp, params, vcancel, vbasis);
+  LPX *lp = Lpx_val(blp);
+  cancel_token *cancel = Cancel_opt_val(vcancel);
+  void (*build)(LPX*) = Is_block(vbasis) ? initial_basis_table[Int_val(Field(vbasis, 0))] : NULL;
+  glp_smcp parm;
+  int ret;
+
+  smcp_val(params, &parm);
+  caml_enter_blocking_section();
+  if (build)
+    build(lp);
+  ret = simplex_cancellable(lp, &parm, cancel);
+  caml_leave_blocking_section();
+
+  raise_on_glp_error(ret);
+  CAMLreturn(Val_unit);
+}
+
+CAMLprim value ocaml_glpk_interior_with_params(value blp, value params)
+{
+  CAMLparam2(blp, params);
+  LPX *lp = Lpx_val(blp);
+  glp_iptcp parm;
+  int ret;
+
+  iptcp_val(params, &parm);
+  caml_enter_blocking_section();
+  ret = glp_interior(lp, &parm);
+  caml_leave_blocking_section();
+
+  raise_on_glp_error(ret);
+  CAMLreturn(Val_unit);
+}
+
+CAMLprim value ocaml_glpk_branch_and_bound_with_params(value blp, value params, value vcancel, value vprogress)
+{
+  CAMLparam4(blp, params, vcancel, vprogress);
+  LPX *lp = Lpx_val(blp);
+  mip_callback_info mci;
+  glp_iocp parm;
+  int ret;
+
+  iocp_val(params, &parm);
+  mci.cancel = Cancel_opt_val(vcancel);
+  mci.progress = Progress_opt_val(vprogress);
+  if (mci.progress)
+    progress_start(mci.progress);
+  if (mci.cancel || mci.progress)
+  {
+    parm.cb_func = mip_callback;
+    parm.cb_info = &mci;
+  }
+  caml_enter_blocking_section();
+  ret = glp_intopt(lp, &parm);
+  caml_leave_blocking_section();
+
+  raise_on_glp_error(ret);
+  CAMLreturn(Val_unit);
+}
 
 CAMLprim value ocaml_glpk_read_cplex(value fname)
 {
@@ -523,3 +2886,744 @@ CAMLprim value ocaml_glpk_write_cplex(value blp, value fname)
     caml_failwith("Error while writing data in CPLEX LP format.");
   return Val_unit;
 }
+
+/* Files in MPS format might be large, so the runtime lock is released while
+ * reading or writing them. */
+CAMLprim value ocaml_glpk_read_mps(value vfree, value fname)
+{
+  CAMLparam2(vfree, fname);
+  char *name = strdup(String_val(fname));
+  int free_format = Bool_val(vfree);
+  LPX *lp;
+
+  if (!name)
+    caml_raise_out_of_memory();
+  caml_enter_blocking_section();
+  lp = free_format ? lpx_read_freemps(name) : lpx_read_mps(name);
+  caml_leave_blocking_section();
+  free(name);
+
+  if (!lp)
+    caml_failwith("Error while reading data in MPS format.");
+  CAMLreturn(new_blp(lp));
+}
+
+CAMLprim value ocaml_glpk_write_mps(value vfree, value blp, value fname)
+{
+  CAMLparam3(vfree, blp, fname);
+  LPX *lp = Lpx_val(blp);
+  char *name = strdup(String_val(fname));
+  int free_format = Bool_val(vfree);
+  int ret;
+
+  if (!name)
+    caml_raise_out_of_memory();
+  caml_enter_blocking_section();
+  ret = free_format ? lpx_write_freemps(lp, name) : lpx_write_mps(lp, name);
+  caml_leave_blocking_section();
+  free(name);
+
+  if (ret)
+    caml_failwith("Error while writing data in MPS format.");
+  CAMLreturn(Val_unit);
+}
+
+CAMLprim value ocaml_glpk_read_basis(value blp, value fname)
+{
+  if (lpx_read_bas(Lpx_val(blp), String_val(fname)))
+    caml_failwith("Error while reading basis in MPS format.");
+  return Val_unit;
+}
+
+CAMLprim value ocaml_glpk_write_basis(value blp, value fname)
+{
+  if (lpx_write_bas(Lpx_val(blp), String_val(fname)))
+    caml_failwith("Error while writing basis in MPS format.");
+  return Val_unit;
+}
+
+/* Models in memory. glpk can only read and write files, so the data goes
+ * through a pipe, opened by glpk as /dev/fd/N, and fed (or drained) by a
+ * helper thread which does not call glpk. */
+typedef LPX* (*model_reader)(const char*);
+typedef int (*model_writer)(LPX*, const char*);
+
+static model_reader model_reader_table[] = {lpx_read_cpxlp, lpx_read_mps, lpx_read_freemps};
+static model_writer model_writer_table[] = {lpx_write_cpxlp, lpx_write_mps, lpx_write_freemps};
+
+typedef struct
+{
+  int fd;
+  char *data;
+  size_t len;
+  size_t size;
+} pipe_buffer;
+
+static void *feed_pipe(void *arg)
+{
+  pipe_buffer *b = (pipe_buffer*)arg;
+  sigset_t set;
+  ssize_t n;
+
+  /* If glpk stops reading before the end, we get EPIPE instead of being
+   * killed. */
+  sigemptyset(&set);
+  sigaddset(&set, SIGPIPE);
+  pthread_sigmask(SIG_BLOCK, &set, NULL);
+  while (b->len > 0)
+  {
+    n = write(b->fd, b->data, b->len);
+    if (n < 0 && errno == EINTR)
+      continue;
+    if (n <= 0)
+      break;
+    b->data += n;
+    b->len -= n;
+  }
+  close(b->fd);
+  return NULL;
+}
+
+static void *drain_pipe(void *arg)
+{
+  pipe_buffer *b = (pipe_buffer*)arg;
+  char scratch[4096];
+  char *data;
+  ssize_t n;
+
+  while (1)
+  {
+    if (b->len == b->size && b->data)
+    {
+      data = realloc(b->data, 2 * b->size);
+      if (data)
+      {
+        b->data = data;
+        b->size *= 2;
+      }
+      else
+      {
+        /* Keep reading so that the writer does not block. */
+        free(b->data);
+        b->data = NULL;
+      }
+    }
+    if (b->data)
+      n = read(b->fd, b->data + b->len, b->size - b->len);
+    else
+      n = read(b->fd, scratch, sizeof(scratch));
+    if (n < 0 && errno == EINTR)
+      continue;
+    if (n <= 0)
+      break;
+    if (b->data)
+      b->len += n;
+  }
+  return NULL;
+}
+
+/* Have a function reading a file read len bytes at data instead, returns
+ * non-zero on error. It should be called without the runtime lock. */
+typedef int (*path_reader)(const char *path, void *arg);
+
+static int read_memory(path_reader f, void *arg, char *data, size_t len)
+{
+  pipe_buffer b;
+  pthread_t thread;
+  char path[32];
+  int fds[2];
+  int ret;
+
+  if (pipe(fds))
+    return 1;
+  b.fd = fds[1];
+  b.data = data;
+  b.len = len;
+  if (pthread_create(&thread, NULL, feed_pipe, &b))
+  {
+    close(fds[0]);
+    close(fds[1]);
+    return 1;
+  }
+  snprintf(path, sizeof(path), "/dev/fd/%d", fds[0]);
+  ret = f(path, arg);
+  close(fds[0]);
+  pthread_join(thread, NULL);
+  return ret;
+}
+
+typedef struct
+{
+  model_reader reader;
+  LPX *lp;
+} model_read;
+
+static int read_model_path(const char *path, void *arg)
+{
+  model_read *r = (model_read*)arg;
+
+  r->lp = r->reader(path);
+  return r->lp == NULL;
+}
+
+static LPX *read_model(model_reader reader, char *data, size_t len)
+{
+  model_read r;
+
+  r.reader = reader;
+  r.lp = NULL;
+  read_memory(read_model_path, &r, data, len);
+  return r.lp;
+}
+
+CAMLprim value ocaml_glpk_read_string(value format, value s)
+{
+  CAMLparam2(format, s);
+  model_reader reader = model_reader_table[Int_val(format)];
+  size_t len = caml_string_length(s);
+  /* The string might be moved by the GC while the runtime lock is released. */
+  char *data = malloc(len ? len : 1);
+  LPX *lp;
+
+  if (!data)
+    caml_raise_out_of_memory();
+  memcpy(data, String_val(s), len);
+  caml_enter_blocking_section();
+  lp = read_model(reader, data, len);
+  caml_leave_blocking_section();
+  free(data);
+
+  if (!lp)
+    caml_failwith("Error while reading model data.");
+  CAMLreturn(new_blp(lp));
+}
+
+CAMLprim value ocaml_glpk_read_bigarray(value format, value ba)
+{
+  CAMLparam2(format, ba);
+  model_reader reader = model_reader_table[Int_val(format)];
+  LPX *lp;
+
+  caml_enter_blocking_section();
+  lp = read_model(reader, Caml_ba_data_val(ba), Ba_len(ba));
+  caml_leave_blocking_section();
+
+  if (!lp)
+    caml_failwith("Error while reading model data.");
+  CAMLreturn(new_blp(lp));
+}
+
+CAMLprim value ocaml_glpk_write_string(value format, value blp)
+{
+  CAMLparam2(format, blp);
+  CAMLlocal1(ans);
+  model_writer writer = model_writer_table[Int_val(format)];
+  LPX *lp = Lpx_val(blp);
+  pipe_buffer b;
+  pthread_t thread;
+  char path[32];
+  int fds[2];
+  int ret = 1;
+
+  if (pipe(fds))
+    caml_failwith("Error while writing model data.");
+  b.fd = fds[0];
+  b.len = 0;
+  b.size = 65536;
+  b.data = malloc(b.size);
+  if (!b.data)
+  {
+    close(fds[0]);
+    close(fds[1]);
+    caml_raise_out_of_memory();
+  }
+  caml_enter_blocking_section();
+  if (pthread_create(&thread, NULL, drain_pipe, &b) == 0)
+  {
+    snprintf(path, sizeof(path), "/dev/fd/%d", fds[1]);
+    ret = writer(lp, path);
+    close(fds[1]);
+    pthread_join(thread, NULL);
+  }
+  else
+    close(fds[1]);
+  close(fds[0]);
+  caml_leave_blocking_section();
+
+  if (!b.data)
+    caml_raise_out_of_memory();
+  if (ret)
+  {
+    free(b.data);
+    caml_failwith("Error while writing model data.");
+  }
+  ans = caml_alloc_string(b.len);
+  memcpy((char*)String_val(ans), b.data, b.len);
+  free(b.data);
+  CAMLreturn(ans);
+}
+
+/* MathProg models. glpk's translator cannot read data sets anymore once the
+ * model has been generated, and a parsed translator cannot be copied, so that a
+ * model only keeps its source (either a file name or the text itself), which
+ * is parsed by its own translator each time it is built with data sets. Since
+ * the source is never modified, this can be done concurrently from several
+ * threads. */
+typedef struct
+{
+  int in_memory;
+  char *source; /* file name or model text */
+  size_t len;
+} mathprog_source;
+
+#define Mathprog_val(v) (*((mathprog_source**)Data_custom_val(v)))
+
+static void finalize_mathprog(value v)
+{
+  mathprog_source *m = Mathprog_val(v);
+
+  free(m->source);
+  free(m);
+}
+
+static struct custom_operations mathprog_ops =
+{
+  "ocaml_glpk_mathprog",
+  finalize_mathprog,
+  custom_compare_default,
+  custom_hash_default,
+  custom_serialize_default,
+  custom_deserialize_default
+};
+
+/* Copy the file name or the text of a source given as Mathprog_file or
+ * Mathprog_string. */
+static void mathprog_source_val(value v, mathprog_source *m)
+{
+  value s = Field(v, 0);
+
+  m->in_memory = Tag_val(v) == 1;
+  m->len = caml_string_length(s);
+  m->source = malloc(m->len + 1);
+  if (!m->source)
+    caml_raise_out_of_memory();
+  memcpy(m->source, String_val(s), m->len);
+  m->source[m->len] = 0;
+}
+
+typedef struct
+{
+  glp_tran *tran;
+  int skip;
+} mathprog_reading;
+
+static int mathprog_read_model(const char *path, void *arg)
+{
+  mathprog_reading *r = (mathprog_reading*)arg;
+
+  return glp_mpl_read_model(r->tran, path, r->skip);
+}
+
+static int mathprog_read_data(const char *path, void *arg)
+{
+  mathprog_reading *r = (mathprog_reading*)arg;
+
+  return glp_mpl_read_data(r->tran, path);
+}
+
+static int mathprog_read(path_reader f, mathprog_reading *r, mathprog_source *s)
+{
+  if (s->in_memory)
+    return read_memory(f, r, s->source, s->len);
+  else
+    return f(s->source, r);
+}
+
+CAMLprim value ocaml_glpk_mathprog_model(value vsource)
+{
+  CAMLparam1(vsource);
+  CAMLlocal1(ans);
+  mathprog_source *m = malloc(sizeof(mathprog_source));
+
+  if (!m)
+    caml_raise_out_of_memory();
+  mathprog_source_val(vsource, m);
+  ans = caml_alloc_custom(&mathprog_ops, sizeof(mathprog_source*), 0, 1);
+  Mathprog_val(ans) = m;
+  CAMLreturn(ans);
+}
+
+/* Translate a model with data sets, should be called without the runtime
+ * lock. */
+static LPX *mathprog_translate(mathprog_source *model, mathprog_source *data, int ndata)
+{
+  mathprog_reading r;
+  LPX *lp = NULL;
+  int i, ret;
+
+  r.tran = glp_mpl_alloc_wksp();
+  /* The data section of the model is ignored when data sets are given. */
+  r.skip = ndata > 0;
+  ret = mathprog_read(mathprog_read_model, &r, model);
+  for(i = 0; !ret && i < ndata; i++)
+    ret = mathprog_read(mathprog_read_data, &r, &data[i]);
+  if (!ret)
+    ret = glp_mpl_generate(r.tran, NULL);
+  if (!ret)
+  {
+    lp = lpx_create_prob();
+    glp_mpl_build_prob(r.tran, lp);
+  }
+  glp_mpl_free_wksp(r.tran);
+  return lp;
+}
+
+CAMLprim value ocaml_glpk_mathprog_build(value vmodel, value vdata)
+{
+  CAMLparam2(vmodel, vdata);
+  mathprog_source *model = Mathprog_val(vmodel);
+  mathprog_source *data;
+  value l;
+  int ndata = 0, i;
+  LPX *lp;
+
+  for(l = vdata; Is_block(l); l = Field(l, 1))
+    ndata++;
+  data = malloc((ndata ? ndata : 1) * sizeof(mathprog_source));
+  if (!data)
+    caml_raise_out_of_memory();
+  for(l = vdata, i = 0; Is_block(l); l = Field(l, 1), i++)
+  {
+    data[i].source = NULL;
+    mathprog_source_val(Field(l, 0), &data[i]);
+  }
+
+  caml_enter_blocking_section();
+  lp = mathprog_translate(model, data, ndata);
+  caml_leave_blocking_section();
+  for(i = 0; i < ndata; i++)
+    free(data[i].source);
+  free(data);
+
+  if (!lp)
+    caml_failwith("Error while translating MathProg model.");
+  CAMLreturn(new_blp(lp));
+}
+
+/* Binary model files, loaded by mapping them in memory.
+ *
+ * The file starts with a header of BINARY_HEADER_SIZE bytes followed by the
+ * arrays below, in native byte order (checked on loading), which are
+ * aligned since the arrays of doubles come first:
+ * - val (nnz doubles), row_lb, row_ub (m doubles), col_lb, col_ub, obj (n
+ *   doubles): the values of the matrix stored by columns and the bounds and
+ *   objective coefficients;
+ * - col_ptr (n + 1 ints): elements of column j are at positions col_ptr[j] to
+ *   col_ptr[j+1]-1;
+ * - row_ind (nnz ints): row indexes of the elements, from 1;
+ * - row_type (m bytes), col_type, col_kind (n bytes): glpk constants;
+ * - if BINARY_NAMES is set in the flags, the names of the problem, of the
+ *   objective, of the rows and of the columns, each one as a byte giving its
+ *   length (0 if there is none) followed by its characters. */
+
+#define BINARY_MAGIC "GLPKBIN"
+#define BINARY_VERSION 1
+#define BINARY_ENDIANNESS 0x01020304
+#define BINARY_HEADER_SIZE 64
+#define BINARY_NAMES 1
+
+typedef struct
+{
+  char magic[8];
+  uint32_t version;
+  uint32_t endianness;
+  uint32_t flags;
+  int32_t m;
+  int32_t n;
+  int32_t nnz;
+  int32_t dir;
+  int32_t reserved;
+  double obj_const;
+} binary_header;
+
+static int write_name(FILE *f, const char *name)
+{
+  unsigned char len = name ? strlen(name) : 0;
+
+  return fwrite(&len, 1, 1, f) != 1 || fwrite(name, 1, len, f) != len;
+}
+
+/* Write a binary model file, returns 0 on success. */
+static int save_binary(LPX *lp, const char *fname, int names)
+{
+  char header[BINARY_HEADER_SIZE];
+  binary_header *h = (binary_header*)header;
+  int m = glp_get_num_rows(lp);
+  int n = glp_get_num_cols(lp);
+  int *ind = malloc((m + 1) * sizeof(int));
+  double *val = malloc((m + 1) * sizeof(double));
+  unsigned char c;
+  int i, j, len, err = 0;
+  double x;
+  FILE *f;
+
+  f = fopen(fname, "wb");
+  if (!f || !ind || !val)
+  {
+    if (f)
+      fclose(f);
+    free(ind);
+    free(val);
+    return 1;
+  }
+  memset(header, 0, sizeof(header));
+  memcpy(h->magic, BINARY_MAGIC, sizeof(BINARY_MAGIC));
+  h->version = BINARY_VERSION;
+  h->endianness = BINARY_ENDIANNESS;
+  h->flags = names ? BINARY_NAMES : 0;
+  h->m = m;
+  h->n = n;
+  h->nnz = glp_get_num_nz(lp);
+  h->dir = glp_get_obj_dir(lp);
+  h->obj_const = glp_get_obj_coef(lp, 0);
+  err |= fwrite(header, sizeof(header), 1, f) != 1;
+
+  for(j = 1; j <= n; j++)
+  {
+    len = glp_get_mat_col(lp, j, NULL, val);
+    err |= fwrite(val + 1, sizeof(double), len, f) != len;
+  }
+#define WRITE_DOUBLES(count, get) \
+  for(i = 1; i <= count; i++) \
+  { \
+    x = get(lp, i); \
+    err |= fwrite(&x, sizeof(double), 1, f) != 1; \
+  }
+  WRITE_DOUBLES(m, glp_get_row_lb);
+  WRITE_DOUBLES(m, glp_get_row_ub);
+  WRITE_DOUBLES(n, glp_get_col_lb);
+  WRITE_DOUBLES(n, glp_get_col_ub);
+  WRITE_DOUBLES(n, glp_get_obj_coef);
+#undef WRITE_DOUBLES
+
+  len = 0;
+  err |= fwrite(&len, sizeof(int), 1, f) != 1;
+  for(j = 1; j <= n; j++)
+  {
+    len += glp_get_mat_col(lp, j, NULL, NULL);
+    err |= fwrite(&len, sizeof(int), 1, f) != 1;
+  }
+  for(j = 1; j <= n; j++)
+  {
+    len = glp_get_mat_col(lp, j, ind, NULL);
+    err |= fwrite(ind + 1, sizeof(int), len, f) != len;
+  }
+
+#define WRITE_BYTES(count, get) \
+  for(i = 1; i <= count; i++) \
+  { \
+    c = get(lp, i); \
+    err |= fwrite(&c, 1, 1, f) != 1; \
+  }
+  WRITE_BYTES(m, glp_get_row_type);
+  WRITE_BYTES(n, glp_get_col_type);
+  WRITE_BYTES(n, glp_get_col_kind);
+#undef WRITE_BYTES
+
+  if (names)
+  {
+    err |= write_name(f, glp_get_prob_name(lp));
+    err |= write_name(f, glp_get_obj_name(lp));
+    for(i = 1; i <= m; i++)
+      err |= write_name(f, glp_get_row_name(lp, i));
+    for(j = 1; j <= n; j++)
+      err |= write_name(f, glp_get_col_name(lp, j));
+  }
+
+  free(ind);
+  free(val);
+  err |= fclose(f) != 0;
+  return err;
+}
+
+/* Load a binary model file, returns NULL on error. The file is mapped in memory
+ * and the matrix is handed to glpk from there without copy. */
+static LPX *load_binary(const char *fname)
+{
+  struct stat st;
+  binary_header h;
+  char *data, *p, *end;
+  double *val, *row_lb, *row_ub, *col_lb, *col_ub, *obj;
+  int *col_ptr, *row_ind, *mark = NULL;
+  unsigned char *row_type, *col_type, *col_kind, len;
+  char name[256];
+  char *names;
+  int fd, i, j, k, m, n, ok = 0;
+  LPX *lp = NULL;
+  size_t size;
+
+  fd = open(fname, O_RDONLY);
+  if (fd < 0)
+    return NULL;
+  if (fstat(fd, &st) || st.st_size < BINARY_HEADER_SIZE)
+  {
+    close(fd);
+    return NULL;
+  }
+  size = st.st_size;
+  data = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (data == MAP_FAILED)
+    return NULL;
+  memcpy(&h, data, sizeof(h));
+  m = h.m;
+  n = h.n;
+  end = data + size;
+
+  if (memcmp(h.magic, BINARY_MAGIC, sizeof(BINARY_MAGIC)) || h.version != BINARY_VERSION ||
+      h.endianness != BINARY_ENDIANNESS || m < 0 || n < 0 || h.nnz < 0 ||
+      (h.dir != GLP_MIN && h.dir != GLP_MAX))
+    goto done;
+  /* Check the size before computing the positions of the arrays. */
+  if (size < BINARY_HEADER_SIZE
+      + ((uint64_t)h.nnz + 2 * (uint64_t)m + 3 * (uint64_t)n) * sizeof(double)
+      + ((uint64_t)n + 1 + h.nnz) * sizeof(int)
+      + (uint64_t)m + 2 * (uint64_t)n)
+    goto done;
+  p = data + BINARY_HEADER_SIZE;
+  val = (double*)p; p += (size_t)h.nnz * sizeof(double);
+  row_lb = (double*)p; p += (size_t)m * sizeof(double);
+  row_ub = (double*)p; p += (size_t)m * sizeof(double);
+  col_lb = (double*)p; p += (size_t)n * sizeof(double);
+  col_ub = (double*)p; p += (size_t)n * sizeof(double);
+  obj = (double*)p; p += (size_t)n * sizeof(double);
+  col_ptr = (int*)p; p += ((size_t)n + 1) * sizeof(int);
+  row_ind = (int*)p; p += (size_t)h.nnz * sizeof(int);
+  row_type = (unsigned char*)p; p += m;
+  col_type = (unsigned char*)p; p += n;
+  col_kind = (unsigned char*)p; p += n;
+
+  /* glpk aborts on invalid data, so that everything is checked first. */
+  if (col_ptr[0] != 0 || col_ptr[n] != h.nnz)
+    goto done;
+  for(j = 0; j < n; j++)
+    if (col_ptr[j] > col_ptr[j+1])
+      goto done;
+  for(i = 0; i < m; i++)
+    if (row_type[i] < GLP_FR || row_type[i] > GLP_FX)
+      goto done;
+  for(j = 0; j < n; j++)
+    if (col_type[j] < GLP_FR || col_type[j] > GLP_FX || col_kind[j] < GLP_CV || col_kind[j] > GLP_BV)
+      goto done;
+  /* Check that row indexes are in bounds and distinct in each column, mark[i]
+   * being the last column where row i was seen. */
+  mark = calloc(m + 1, sizeof(int));
+  if (!mark)
+    goto done;
+  for(j = 0; j < n; j++)
+    for(k = col_ptr[j]; k < col_ptr[j+1]; k++)
+    {
+      i = row_ind[k];
+      if (i < 1 || i > m || mark[i] == j + 1)
+        goto done;
+      mark[i] = j + 1;
+    }
+  names = p;
+  if (h.flags & BINARY_NAMES)
+    for(k = 0; k < m + n + 2; k++)
+    {
+      if (p >= end || p + 1 + (unsigned char)*p > end)
+        goto done;
+      len = *p;
+      if (!valid_name(p + 1, len))
+        goto done;
+      p += 1 + len;
+    }
+
+  lp = lpx_create_prob();
+  glp_set_obj_dir(lp, h.dir);
+  glp_set_obj_coef(lp, 0, h.obj_const);
+  if (m > 0)
+    glp_add_rows(lp, m);
+  if (n > 0)
+    glp_add_cols(lp, n);
+  for(i = 0; i < m; i++)
+    glp_set_row_bnds(lp, i + 1, row_type[i], row_lb[i], row_ub[i]);
+  for(j = 0; j < n; j++)
+  {
+    glp_set_col_kind(lp, j + 1, col_kind[j]);
+    glp_set_col_bnds(lp, j + 1, col_type[j], col_lb[j], col_ub[j]);
+    glp_set_obj_coef(lp, j + 1, obj[j]);
+    /* glpk reads the arrays starting from index 1. */
+    glp_set_mat_col(lp, j + 1, col_ptr[j+1] - col_ptr[j], row_ind + col_ptr[j] - 1, val + col_ptr[j] - 1);
+  }
+
+  if (h.flags & BINARY_NAMES)
+  {
+    p = names;
+    for(k = 0; k < m + n + 2; k++)
+    {
+      len = *p;
+      memcpy(name, p + 1, len);
+      name[len] = 0;
+      p += 1 + len;
+      if (k == 0)
+        glp_set_prob_name(lp, name);
+      else if (k == 1)
+        glp_set_obj_name(lp, name);
+      else if (k < m + 2)
+        glp_set_row_name(lp, k - 1, name);
+      else
+        glp_set_col_name(lp, k - m - 1, name);
+    }
+  }
+  ok = 1;
+
+done:
+  free(mark);
+  munmap(data, size);
+  if (!ok && lp)
+  {
+    lpx_delete_prob(lp);
+    lp = NULL;
+  }
+  return lp;
+}
+
+CAMLprim value ocaml_glpk_save_binary(value vnames, value blp, value fname)
+{
+  CAMLparam3(vnames, blp, fname);
+  LPX *lp = Lpx_val(blp);
+  char *name = strdup(String_val(fname));
+  int names = Bool_val(vnames);
+  int ret;
+
+  if (!name)
+    caml_raise_out_of_memory();
+  caml_enter_blocking_section();
+  ret = save_binary(lp, name, names);
+  caml_leave_blocking_section();
+  free(name);
+
+  if (ret)
+    caml_failwith("Error while writing binary model.");
+  CAMLreturn(Val_unit);
+}
+
+CAMLprim value ocaml_glpk_load_binary(value fname)
+{
+  CAMLparam1(fname);
+  char *name = strdup(String_val(fname));
+  LPX *lp;
+
+  if (!name)
+    caml_raise_out_of_memory();
+  caml_enter_blocking_section();
+  lp = load_binary(name);
+  caml_leave_blocking_section();
+  free(name);
+
+  if (!lp)
+    caml_failwith("Error while reading binary model.");
+  CAMLreturn(new_blp(lp));
+}
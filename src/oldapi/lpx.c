@@ -8,175 +8,25 @@
 *  To compile an existing project using these routines you need to add
 *  to the project this file and the header lpx.h.
 *
-*  Please note that you may mix calls to old and new GLPK API routines
-*  (except calls to glp_create_prob and glp_delete_prob). */
+*  Please note that you may mix calls to old and new GLPK API routines.
+*
+*  This version has been modified for ocaml-glpk: control parameters are
+*  not kept in a global list anymore but owned by the caller, which
+*  passes them to the routines using them (see LPXCPS in lpx.h), and
+*  lpx_read_bas and lpx_write_bas are implemented. */
 
 #include <float.h>
 #include <limits.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include "lpx.h"
 
 #define xassert glp_assert
 #define xerror  glp_error
 
-struct CPS
-{     /* control parameters */
-      LPX *lp;
-      /* pointer to corresponding problem object */
-      int msg_lev;
-      /* level of messages output by the solver:
-         0 - no output
-         1 - error messages only
-         2 - normal output
-         3 - full output (includes informational messages) */
-      int scale;
-      /* scaling option:
-         0 - no scaling
-         1 - equilibration scaling
-         2 - geometric mean scaling
-         3 - geometric mean scaling, then equilibration scaling */
-      int dual;
-      /* dual simplex option:
-         0 - use primal simplex
-         1 - use dual simplex */
-      int price;
-      /* pricing option (for both primal and dual simplex):
-         0 - textbook pricing
-         1 - steepest edge pricing */
-      double relax;
-      /* relaxation parameter used in the ratio test; if it is zero,
-         the textbook ratio test is used; if it is non-zero (should be
-         positive), Harris' two-pass ratio test is used; in the latter
-         case on the first pass basic variables (in the case of primal
-         simplex) or reduced costs of non-basic variables (in the case
-         of dual simplex) are allowed to slightly violate their bounds,
-         but not more than (relax * tol_bnd) or (relax * tol_dj) (thus,
-         relax is a percentage of tol_bnd or tol_dj) */
-      double tol_bnd;
-      /* relative tolerance used to check if the current basic solution
-         is primal feasible */
-      double tol_dj;
-      /* absolute tolerance used to check if the current basic solution
-         is dual feasible */
-      double tol_piv;
-      /* relative tolerance used to choose eligible pivotal elements of
-         the simplex table in the ratio test */
-      int round;
-      /* solution rounding option:
-         0 - report all computed values and reduced costs "as is"
-         1 - if possible (allowed by the tolerances), replace computed
-             values and reduced costs which are close to zero by exact
-             zeros */
-      double obj_ll;
-      /* lower limit of the objective function; if on the phase II the
-         objective function reaches this limit and continues decreasing,
-         the solver stops the search */
-      double obj_ul;
-      /* upper limit of the objective function; if on the phase II the
-         objective function reaches this limit and continues increasing,
-         the solver stops the search */
-      int it_lim;
-      /* simplex iterations limit; if this value is positive, it is
-         decreased by one each time when one simplex iteration has been
-         performed, and reaching zero value signals the solver to stop
-         the search; negative value means no iterations limit */
-      double tm_lim;
-      /* searching time limit, in seconds; if this value is positive,
-         it is decreased each time when one simplex iteration has been
-         performed by the amount of time spent for the iteration, and
-         reaching zero value signals the solver to stop the search;
-         negative value means no time limit */
-      int out_frq;
-      /* output frequency, in iterations; this parameter specifies how
-         frequently the solver sends information about the solution to
-         the standard output */
-      double out_dly;
-      /* output delay, in seconds; this parameter specifies how long
-         the solver should delay sending information about the solution
-         to the standard output; zero value means no delay */
-      int branch; /* MIP */
-      /* branching heuristic:
-         0 - branch on first variable
-         1 - branch on last variable
-         2 - branch using heuristic by Driebeck and Tomlin
-         3 - branch on most fractional variable */
-      int btrack; /* MIP */
-      /* backtracking heuristic:
-         0 - select most recent node (depth first search)
-         1 - select earliest node (breadth first search)
-         2 - select node using the best projection heuristic
-         3 - select node with best local bound */
-      double tol_int; /* MIP */
-      /* absolute tolerance used to check if the current basic solution
-         is integer feasible */
-      double tol_obj; /* MIP */
-      /* relative tolerance used to check if the value of the objective
-         function is not better than in the best known integer feasible
-         solution */
-      int mps_info; /* lpx_write_mps */
-      /* if this flag is set, the routine lpx_write_mps outputs several
-         comment cards that contains some information about the problem;
-         otherwise the routine outputs no comment cards */
-      int mps_obj; /* lpx_write_mps */
-      /* this parameter tells the routine lpx_write_mps how to output
-         the objective function row:
-         0 - never output objective function row
-         1 - always output objective function row
-         2 - output objective function row if and only if the problem
-             has no free rows */
-      int mps_orig; /* lpx_write_mps */
-      /* if this flag is set, the routine lpx_write_mps uses original
-         row and column symbolic names; otherwise the routine generates
-         plain names using ordinal numbers of rows and columns */
-      int mps_wide; /* lpx_write_mps */
-      /* if this flag is set, the routine lpx_write_mps uses all data
-         fields; otherwise the routine keeps fields 5 and 6 empty */
-      int mps_free; /* lpx_write_mps */
-      /* if this flag is set, the routine lpx_write_mps omits column
-         and vector names everytime if possible (free style); otherwise
-         the routine never omits these names (pedantic style) */
-      int mps_skip; /* lpx_write_mps */
-      /* if this flag is set, the routine lpx_write_mps skips empty
-         columns (i.e. which has no constraint coefficients); otherwise
-         the routine outputs all columns */
-      int lpt_orig; /* lpx_write_lpt */
-      /* if this flag is set, the routine lpx_write_lpt uses original
-         row and column symbolic names; otherwise the routine generates
-         plain names using ordinal numbers of rows and columns */
-      int presol; /* lpx_simplex */
-      /* LP presolver option:
-         0 - do not use LP presolver
-         1 - use LP presolver */
-      int binarize; /* lpx_intopt */
-      /* if this flag is set, the routine lpx_intopt replaces integer
-         columns by binary ones */
-      int use_cuts; /* lpx_intopt */
-      /* if this flag is set, the routine lpx_intopt tries generating
-         cutting planes:
-         LPX_C_COVER  - mixed cover cuts
-         LPX_C_CLIQUE - clique cuts
-         LPX_C_GOMORY - Gomory's mixed integer cuts
-         LPX_C_ALL    - all cuts */
-      double mip_gap; /* MIP */
-      /* relative MIP gap tolerance */
-      struct CPS *link;
-      /* pointer to CPS for another problem object */
-};
-
-static struct CPS *cps_ptr = NULL;
-/* initial pointer to CPS linked list */
-
-static struct CPS *find_cps(LPX *lp)
-{     /* find CPS for specified problem object */
-      struct CPS *cps;
-      for (cps = cps_ptr; cps != NULL; cps = cps->link)
-         if (cps->lp == lp) break;
-      /* if cps is NULL (not found), the problem object was created
-         with glp_create_prob rather than with lpx_create_prob */
-      xassert(cps != NULL);
-      return cps;
-}
-
-static void reset_cps(struct CPS *cps)
+void lpx_reset_parms(LPXCPS *cps)
 {     /* reset control parameters to default values */
       cps->msg_lev  = 3;
       cps->scale    = 1;
@@ -213,15 +63,7 @@ static void reset_cps(struct CPS *cps)
 
 LPX *lpx_create_prob(void)
 {     /* create problem object */
-      LPX *lp;
-      struct CPS *cps;
-      lp = glp_create_prob();
-      cps = glp_alloc(1, sizeof(struct CPS));
-      cps->lp = lp;
-      reset_cps(cps);
-      cps->link = cps_ptr;
-      cps_ptr = cps;
-      return lp;
+      return glp_create_prob();
 }
 
 void lpx_set_prob_name(LPX *lp, const char *name)
@@ -317,17 +159,6 @@ void lpx_del_cols(LPX *lp, int ncs, const int num[])
 
 void lpx_delete_prob(LPX *lp)
 {     /* delete problem object */
-      struct CPS *cps = find_cps(lp);
-      if (cps_ptr == cps)
-         cps_ptr = cps->link;
-      else
-      {  struct CPS *prev;
-         for (prev = cps_ptr; prev != NULL; prev = prev->link)
-            if (prev->link == cps) break;
-         xassert(prev != NULL);
-         prev->link = cps->link;
-      }
-      glp_free(cps);
       glp_delete_prob(lp);
       return;
 }
@@ -469,9 +300,9 @@ void lpx_delete_index(LPX *lp)
       return;
 }
 
-void lpx_scale_prob(LPX *lp)
+void lpx_scale_prob(LPX *lp, const LPXCPS *cps)
 {     /* scale problem data */
-      switch (lpx_get_int_parm(lp, LPX_K_SCALE))
+      switch (lpx_get_int_parm(lp, cps, LPX_K_SCALE))
       {  case 0:
             /* no scaling */
             glp_unscale_prob(lp);
@@ -530,47 +361,47 @@ void lpx_cpx_basis(LPX *lp)
       return;
 }
 
-static void fill_smcp(LPX *lp, glp_smcp *parm)
+static void fill_smcp(LPX *lp, const LPXCPS *cps, glp_smcp *parm)
 {     glp_init_smcp(parm);
-      switch (lpx_get_int_parm(lp, LPX_K_MSGLEV))
+      switch (lpx_get_int_parm(lp, cps, LPX_K_MSGLEV))
       {  case 0:  parm->msg_lev = GLP_MSG_OFF;   break;
          case 1:  parm->msg_lev = GLP_MSG_ERR;   break;
          case 2:  parm->msg_lev = GLP_MSG_ON;    break;
          case 3:  parm->msg_lev = GLP_MSG_ALL;   break;
          default: xassert(lp != lp);
       }
-      switch (lpx_get_int_parm(lp, LPX_K_DUAL))
+      switch (lpx_get_int_parm(lp, cps, LPX_K_DUAL))
       {  case 0:  parm->meth = GLP_PRIMAL;       break;
          case 1:  parm->meth = GLP_DUAL;         break;
          default: xassert(lp != lp);
       }
-      switch (lpx_get_int_parm(lp, LPX_K_PRICE))
+      switch (lpx_get_int_parm(lp, cps, LPX_K_PRICE))
       {  case 0:  parm->pricing = GLP_PT_STD;    break;
          case 1:  parm->pricing = GLP_PT_PSE;    break;
          default: xassert(lp != lp);
       }
-      if (lpx_get_real_parm(lp, LPX_K_RELAX) == 0.0)
+      if (lpx_get_real_parm(lp, cps, LPX_K_RELAX) == 0.0)
          parm->r_test = GLP_RT_STD;
       else
          parm->r_test = GLP_RT_HAR;
-      parm->tol_bnd = lpx_get_real_parm(lp, LPX_K_TOLBND);
-      parm->tol_dj  = lpx_get_real_parm(lp, LPX_K_TOLDJ);
-      parm->tol_piv = lpx_get_real_parm(lp, LPX_K_TOLPIV);
-      parm->obj_ll  = lpx_get_real_parm(lp, LPX_K_OBJLL);
-      parm->obj_ul  = lpx_get_real_parm(lp, LPX_K_OBJUL);
-      if (lpx_get_int_parm(lp, LPX_K_ITLIM) < 0)
+      parm->tol_bnd = lpx_get_real_parm(lp, cps, LPX_K_TOLBND);
+      parm->tol_dj  = lpx_get_real_parm(lp, cps, LPX_K_TOLDJ);
+      parm->tol_piv = lpx_get_real_parm(lp, cps, LPX_K_TOLPIV);
+      parm->obj_ll  = lpx_get_real_parm(lp, cps, LPX_K_OBJLL);
+      parm->obj_ul  = lpx_get_real_parm(lp, cps, LPX_K_OBJUL);
+      if (lpx_get_int_parm(lp, cps, LPX_K_ITLIM) < 0)
          parm->it_lim = INT_MAX;
       else
-         parm->it_lim = lpx_get_int_parm(lp, LPX_K_ITLIM);
-      if (lpx_get_real_parm(lp, LPX_K_TMLIM) < 0.0)
+         parm->it_lim = lpx_get_int_parm(lp, cps, LPX_K_ITLIM);
+      if (lpx_get_real_parm(lp, cps, LPX_K_TMLIM) < 0.0)
          parm->tm_lim = INT_MAX;
       else
          parm->tm_lim =
-            (int)(1000.0 * lpx_get_real_parm(lp, LPX_K_TMLIM));
-      parm->out_frq = lpx_get_int_parm(lp, LPX_K_OUTFRQ);
+            (int)(1000.0 * lpx_get_real_parm(lp, cps, LPX_K_TMLIM));
+      parm->out_frq = lpx_get_int_parm(lp, cps, LPX_K_OUTFRQ);
       parm->out_dly =
-            (int)(1000.0 * lpx_get_real_parm(lp, LPX_K_OUTDLY));
-      switch (lpx_get_int_parm(lp, LPX_K_PRESOL))
+            (int)(1000.0 * lpx_get_real_parm(lp, cps, LPX_K_OUTDLY));
+      switch (lpx_get_int_parm(lp, cps, LPX_K_PRESOL))
       {  case 0:  parm->presolve = GLP_OFF;      break;
          case 1:  parm->presolve = GLP_ON;       break;
          default: xassert(lp != lp);
@@ -578,11 +409,11 @@ static void fill_smcp(LPX *lp, glp_smcp *parm)
       return;
 }
 
-int lpx_simplex(LPX *lp)
+int lpx_simplex(LPX *lp, const LPXCPS *cps)
 {     /* easy-to-use driver to the simplex method */
       glp_smcp parm;
       int ret;
-      fill_smcp(lp, &parm);
+      fill_smcp(lp, cps, &parm);
       ret = glp_simplex(lp, &parm);
       switch (ret)
       {  case 0:           ret = LPX_E_OK;      break;
@@ -602,11 +433,11 @@ int lpx_simplex(LPX *lp)
       return ret;
 }
 
-int lpx_exact(LPX *lp)
+int lpx_exact(LPX *lp, const LPXCPS *cps)
 {     /* easy-to-use driver to the exact simplex method */
       glp_smcp parm;
       int ret;
-      fill_smcp(lp, &parm);
+      fill_smcp(lp, cps, &parm);
       ret = glp_exact(lp, &parm);
       switch (ret)
       {  case 0:           ret = LPX_E_OK;      break;
@@ -749,7 +580,7 @@ void lpx_check_kkt(LPX *lp, int scaled, LPXKKT *kkt)
       if (re_ind == 0)
          kkt->de_re_col = 0;
       else
-         kkt->de_re_col = ae_ind - m;
+         kkt->de_re_col = re_ind - m;
       if (re_max <= 1e-9)
          kkt->de_quality = 'H';
       else if (re_max <= 1e-6)
@@ -919,58 +750,58 @@ int lpx_get_num_bin(LPX *lp)
       return glp_get_num_bin(lp);
 }
 
-static int solve_mip(LPX *lp, int presolve)
+static int solve_mip(LPX *lp, const LPXCPS *cps, int presolve)
 {     glp_iocp parm;
       int ret;
       glp_init_iocp(&parm);
-      switch (lpx_get_int_parm(lp, LPX_K_MSGLEV))
+      switch (lpx_get_int_parm(lp, cps, LPX_K_MSGLEV))
       {  case 0:  parm.msg_lev = GLP_MSG_OFF;   break;
          case 1:  parm.msg_lev = GLP_MSG_ERR;   break;
          case 2:  parm.msg_lev = GLP_MSG_ON;    break;
          case 3:  parm.msg_lev = GLP_MSG_ALL;   break;
          default: xassert(lp != lp);
       }
-      switch (lpx_get_int_parm(lp, LPX_K_BRANCH))
+      switch (lpx_get_int_parm(lp, cps, LPX_K_BRANCH))
       {  case 0:  parm.br_tech = GLP_BR_FFV;    break;
          case 1:  parm.br_tech = GLP_BR_LFV;    break;
          case 2:  parm.br_tech = GLP_BR_DTH;    break;
          case 3:  parm.br_tech = GLP_BR_MFV;    break;
          default: xassert(lp != lp);
       }
-      switch (lpx_get_int_parm(lp, LPX_K_BTRACK))
+      switch (lpx_get_int_parm(lp, cps, LPX_K_BTRACK))
       {  case 0:  parm.bt_tech = GLP_BT_DFS;    break;
          case 1:  parm.bt_tech = GLP_BT_BFS;    break;
          case 2:  parm.bt_tech = GLP_BT_BPH;    break;
          case 3:  parm.bt_tech = GLP_BT_BLB;    break;
          default: xassert(lp != lp);
       }
-      parm.tol_int = lpx_get_real_parm(lp, LPX_K_TOLINT);
-      parm.tol_obj = lpx_get_real_parm(lp, LPX_K_TOLOBJ);
-      if (lpx_get_real_parm(lp, LPX_K_TMLIM) < 0.0 ||
-          lpx_get_real_parm(lp, LPX_K_TMLIM) > 1e6)
+      parm.tol_int = lpx_get_real_parm(lp, cps, LPX_K_TOLINT);
+      parm.tol_obj = lpx_get_real_parm(lp, cps, LPX_K_TOLOBJ);
+      if (lpx_get_real_parm(lp, cps, LPX_K_TMLIM) < 0.0 ||
+          lpx_get_real_parm(lp, cps, LPX_K_TMLIM) > 1e6)
          parm.tm_lim = INT_MAX;
       else
          parm.tm_lim =
-            (int)(1000.0 * lpx_get_real_parm(lp, LPX_K_TMLIM));
-      parm.mip_gap = lpx_get_real_parm(lp, LPX_K_MIPGAP);
-      if (lpx_get_int_parm(lp, LPX_K_USECUTS) & LPX_C_GOMORY)
+            (int)(1000.0 * lpx_get_real_parm(lp, cps, LPX_K_TMLIM));
+      parm.mip_gap = lpx_get_real_parm(lp, cps, LPX_K_MIPGAP);
+      if (lpx_get_int_parm(lp, cps, LPX_K_USECUTS) & LPX_C_GOMORY)
          parm.gmi_cuts = GLP_ON;
       else
          parm.gmi_cuts = GLP_OFF;
-      if (lpx_get_int_parm(lp, LPX_K_USECUTS) & LPX_C_MIR)
+      if (lpx_get_int_parm(lp, cps, LPX_K_USECUTS) & LPX_C_MIR)
          parm.mir_cuts = GLP_ON;
       else
          parm.mir_cuts = GLP_OFF;
-      if (lpx_get_int_parm(lp, LPX_K_USECUTS) & LPX_C_COVER)
+      if (lpx_get_int_parm(lp, cps, LPX_K_USECUTS) & LPX_C_COVER)
          parm.cov_cuts = GLP_ON;
       else
          parm.cov_cuts = GLP_OFF;
-      if (lpx_get_int_parm(lp, LPX_K_USECUTS) & LPX_C_CLIQUE)
+      if (lpx_get_int_parm(lp, cps, LPX_K_USECUTS) & LPX_C_CLIQUE)
          parm.clq_cuts = GLP_ON;
       else
          parm.clq_cuts = GLP_OFF;
       parm.presolve = presolve;
-      if (lpx_get_int_parm(lp, LPX_K_BINARIZE))
+      if (lpx_get_int_parm(lp, cps, LPX_K_BINARIZE))
          parm.binarize = GLP_ON;
       ret = glp_intopt(lp, &parm);
       switch (ret)
@@ -987,14 +818,14 @@ static int solve_mip(LPX *lp, int presolve)
       return ret;
 }
 
-int lpx_integer(LPX *lp)
+int lpx_integer(LPX *lp, const LPXCPS *cps)
 {     /* easy-to-use driver to the branch-and-bound method */
-      return solve_mip(lp, GLP_OFF);
+      return solve_mip(lp, cps, GLP_OFF);
 }
 
-int lpx_intopt(LPX *lp)
+int lpx_intopt(LPX *lp, const LPXCPS *cps)
 {     /* easy-to-use driver to the branch-and-bound method */
-      return solve_mip(lp, GLP_ON);
+      return solve_mip(lp, cps, GLP_ON);
 }
 
 int lpx_mip_status(glp_prob *lp)
@@ -1060,16 +891,8 @@ void lpx_check_int(LPX *lp, LPXKKT *kkt)
       return;
 }
 
-void lpx_reset_parms(LPX *lp)
-{     /* reset control parameters to default values */
-      struct CPS *cps = find_cps(lp);
-      reset_cps(cps);
-      return;
-}
-
-void lpx_set_int_parm(LPX *lp, int parm, int val)
+void lpx_set_int_parm(LPX *lp, LPXCPS *cps, int parm, int val)
 {     /* set (change) integer control parameter */
-      struct CPS *cps = find_cps(lp);
       switch (parm)
       {  case LPX_K_MSGLEV:
             if (!(0 <= val && val <= 3))
@@ -1209,9 +1032,8 @@ void lpx_set_int_parm(LPX *lp, int parm, int val)
       return;
 }
 
-int lpx_get_int_parm(LPX *lp, int parm)
+int lpx_get_int_parm(LPX *lp, const LPXCPS *cps, int parm)
 {     /* query integer control parameter */
-      struct CPS *cps = find_cps(lp);
       int val = 0;
       switch (parm)
       {  case LPX_K_MSGLEV:
@@ -1276,9 +1098,9 @@ int lpx_get_int_parm(LPX *lp, int parm)
       return val;
 }
 
-void lpx_set_real_parm(LPX *lp, int parm, double val)
+void lpx_set_real_parm(LPX *lp, LPXCPS *cps, int parm, double val)
 {     /* set (change) real control parameter */
-      struct CPS *cps = find_cps(lp);
+      (void)lp;
       switch (parm)
       {  case LPX_K_RELAX:
             if (!(0.0 <= val && val <= 1.0))
@@ -1341,10 +1163,10 @@ void lpx_set_real_parm(LPX *lp, int parm, double val)
       return;
 }
 
-double lpx_get_real_parm(LPX *lp, int parm)
+double lpx_get_real_parm(LPX *lp, const LPXCPS *cps, int parm)
 {     /* query real control parameter */
-      struct CPS *cps = find_cps(lp);
       double val = 0.0;
+      (void)lp;
       switch (parm)
       {  case LPX_K_RELAX:
             val = cps->relax;
@@ -1399,19 +1221,243 @@ int lpx_write_mps(LPX *lp, const char *fname)
       return glp_write_mps(lp, GLP_MPS_DECK, NULL, fname);
 }
 
+static int bas_nonbasic_stat(int type, int upper)
+{     /* status of a non-basic variable of given type */
+      switch (type)
+      {  case GLP_FR: return GLP_NF;
+         case GLP_LO: return GLP_NL;
+         case GLP_UP: return GLP_NU;
+         case GLP_DB: return upper ? GLP_NU : GLP_NL;
+         case GLP_FX: return GLP_NS;
+         default:     xassert(type != type);
+      }
+      return 0;
+}
+
+static const char *bas_row_name(LPX *lp, int i, char buf[])
+{     /* name of a row, "R<i>" if it has none */
+      const char *name = glp_get_row_name(lp, i);
+      if (name == NULL) sprintf(buf, "R%d", i), name = buf;
+      return name;
+}
+
+static const char *bas_col_name(LPX *lp, int j, char buf[])
+{     /* name of a column, "C<j>" if it has none */
+      const char *name = glp_get_col_name(lp, j);
+      if (name == NULL) sprintf(buf, "C%d", j), name = buf;
+      return name;
+}
+
+typedef struct { const char *name; int k; } BASNAME;
+
+static int bas_compare(const void *a, const void *b)
+{     /* compare entries of a name table */
+      return strcmp(((const BASNAME *)a)->name,
+         ((const BASNAME *)b)->name);
+}
+
+static BASNAME *bas_names(LPX *lp, int row, int *cnt)
+{     /* build a sorted table of the names of rows or columns; the
+         name index of the problem object is not used, so that it is
+         left as it was */
+      BASNAME *tab;
+      const char *name;
+      int k, n = row ? glp_get_num_rows(lp) : glp_get_num_cols(lp);
+      tab = glp_alloc(1 + n, sizeof(BASNAME));
+      *cnt = 0;
+      for (k = 1; k <= n; k++)
+      {  name = row ? glp_get_row_name(lp, k) : glp_get_col_name(lp, k);
+         if (name == NULL) continue;
+         tab[*cnt].name = name, tab[*cnt].k = k, (*cnt)++;
+      }
+      qsort(tab, *cnt, sizeof(BASNAME), bas_compare);
+      return tab;
+}
+
+static int bas_find(LPX *lp, int row, BASNAME *tab, int cnt,
+      const char *name)
+{     /* find a row or column by name, 0 if not found */
+      BASNAME key, *e;
+      int k, len, n;
+      key.name = name;
+      e = bsearch(&key, tab, cnt, sizeof(BASNAME), bas_compare);
+      if (e != NULL) return e->k;
+      /* unnamed rows and columns are referred to as R<i> and C<j> */
+      n = row ? glp_get_num_rows(lp) : glp_get_num_cols(lp);
+      if (name[0] != (row ? 'R' : 'C')) return 0;
+      if (sscanf(name + 1, "%d%n", &k, &len) != 1) return 0;
+      if (name[len + 1] != '\0' || k < 1 || k > n) return 0;
+      if ((row ? glp_get_row_name(lp, k) : glp_get_col_name(lp, k))
+          != NULL) return 0;
+      return k;
+}
+
+static char *bas_read_line(FILE *fp, char **buf, int *size)
+{     /* read a line of any length without its newline, NULL on end of
+         file or error */
+      int c, len = 0;
+      while ((c = fgetc(fp)) != EOF && c != '\n')
+      {  if (len + 1 >= *size)
+         {  char *old = *buf;
+            *size *= 2;
+            *buf = glp_alloc(*size, sizeof(char));
+            memcpy(*buf, old, len);
+            glp_free(old);
+         }
+         (*buf)[len++] = (char)c;
+      }
+      if (c == EOF && (len == 0 || ferror(fp))) return NULL;
+      (*buf)[len] = '\0';
+      return *buf;
+}
+
+static char *bas_field(char **ptr)
+{     /* next field of a data line separated by white spaces, NULL if
+         there are no more */
+      char *p = *ptr, *f;
+      while (*p == ' ' || *p == '\t' || *p == '\r') p++;
+      if (*p == '\0') return NULL;
+      f = p;
+      while (*p != '\0' && *p != ' ' && *p != '\t' && *p != '\r') p++;
+      if (*p != '\0') *p++ = '\0';
+      *ptr = p;
+      return f;
+}
+
 int lpx_read_bas(LPX *lp, const char *fname)
 {     /* read LP basis in fixed MPS format */
-      xassert(lp == lp);
-      xassert(fname == fname);
-      xerror("lpx_read_bas: operation not supported\n");
-      return 0;
+      /* This implementation reads the fields of data lines separated by
+         white spaces and thus does not support names containing spaces.
+         The basis is read into temporary arrays and installed in the
+         problem object only if the whole file is valid. */
+      FILE *fp;
+      BASNAME *rtab, *ctab;
+      char *line, *ptr, *f, *name1, *name2;
+      int m = glp_get_num_rows(lp), n = glp_get_num_cols(lp);
+      int *rstat, *cstat, rcnt, ccnt, size = 256;
+      int i, j, type, count = 0, ret = 1, ok = 0;
+      fp = fopen(fname, "r");
+      if (fp == NULL)
+      {  glp_printf("lpx_read_bas: unable to open '%s'\n", fname);
+         return 1;
+      }
+      line = glp_alloc(size, sizeof(char));
+      rtab = bas_names(lp, 1, &rcnt);
+      ctab = bas_names(lp, 0, &ccnt);
+      /* start from the standard basis, as glp_std_basis would */
+      rstat = glp_alloc(1 + m, sizeof(int));
+      cstat = glp_alloc(1 + n, sizeof(int));
+      for (i = 1; i <= m; i++)
+         rstat[i] = GLP_BS;
+      for (j = 1; j <= n; j++)
+      {  type = glp_get_col_type(lp, j);
+         cstat[j] = bas_nonbasic_stat(type, type == GLP_DB &&
+            fabs(glp_get_col_lb(lp, j)) > fabs(glp_get_col_ub(lp, j)));
+      }
+      while (bas_read_line(fp, &line, &size) != NULL)
+      {  count++;
+         if (line[0] == '*' || line[0] == '\0') continue;
+         if (line[0] != ' ')
+         {  if (strncmp(line, "NAME", 4) == 0) continue;
+            if (strncmp(line, "ENDATA", 6) == 0) { ok = 1; break; }
+            goto err;
+         }
+         ptr = line;
+         f = bas_field(&ptr);
+         name1 = bas_field(&ptr);
+         name2 = bas_field(&ptr);
+         if (f == NULL || name1 == NULL || bas_field(&ptr) != NULL)
+            goto err;
+         j = bas_find(lp, 0, ctab, ccnt, name1);
+         if (j == 0) goto err;
+         if (strcmp(f, "XU") == 0 || strcmp(f, "XL") == 0)
+         {  if (name2 == NULL) goto err;
+            i = bas_find(lp, 1, rtab, rcnt, name2);
+            if (i == 0) goto err;
+            cstat[j] = GLP_BS;
+            rstat[i] = bas_nonbasic_stat(glp_get_row_type(lp, i),
+               f[1] == 'U');
+         }
+         else if (strcmp(f, "UL") == 0 || strcmp(f, "LL") == 0)
+         {  if (name2 != NULL) goto err;
+            cstat[j] = bas_nonbasic_stat(glp_get_col_type(lp, j),
+               f[0] == 'U');
+         }
+         else
+            goto err;
+      }
+      if (ferror(fp))
+      {  glp_printf("lpx_read_bas: read error on '%s'\n", fname);
+         goto done;
+      }
+      if (!ok)
+      {  glp_printf("lpx_read_bas: %s: missing ENDATA\n", fname);
+         goto done;
+      }
+      for (i = 1; i <= m; i++)
+         glp_set_row_stat(lp, i, rstat[i]);
+      for (j = 1; j <= n; j++)
+         glp_set_col_stat(lp, j, cstat[j]);
+      ret = 0;
+      goto done;
+err:  glp_printf("lpx_read_bas: %s:%d: invalid data line\n", fname,
+         count);
+done: fclose(fp);
+      glp_free(line);
+      glp_free(rtab);
+      glp_free(ctab);
+      glp_free(rstat);
+      glp_free(cstat);
+      return ret;
 }
 
 int lpx_write_bas(LPX *lp, const char *fname)
 {     /* write LP basis in fixed MPS format */
-      xassert(lp == lp);
-      xassert(fname == fname);
-      xerror("lpx_write_bas: operation not supported\n");
+      FILE *fp;
+      char buf1[32], buf2[32];
+      const char *name;
+      int m = glp_get_num_rows(lp), n = glp_get_num_cols(lp);
+      int i, j, nbr = 0, bc = 0;
+      /* basic columns are written along with non-basic rows, so that
+         their numbers should be equal in a valid basis */
+      for (i = 1; i <= m; i++)
+         if (glp_get_row_stat(lp, i) != GLP_BS) nbr++;
+      for (j = 1; j <= n; j++)
+         if (glp_get_col_stat(lp, j) == GLP_BS) bc++;
+      if (nbr != bc)
+      {  glp_printf("lpx_write_bas: invalid basis\n");
+         return 1;
+      }
+      fp = fopen(fname, "w");
+      if (fp == NULL)
+      {  glp_printf("lpx_write_bas: unable to create '%s'\n", fname);
+         return 1;
+      }
+      name = glp_get_prob_name(lp);
+      fprintf(fp, "NAME          %s\n", name == NULL ? "" : name);
+      i = 0;
+      for (j = 1; j <= n; j++)
+      {  switch (glp_get_col_stat(lp, j))
+         {  case GLP_BS:
+               for (i++; glp_get_row_stat(lp, i) == GLP_BS; i++);
+               fprintf(fp, " %s %-8s  %s\n",
+                  glp_get_row_stat(lp, i) == GLP_NU ? "XU" : "XL",
+                  bas_col_name(lp, j, buf1), bas_row_name(lp, i, buf2));
+               break;
+            case GLP_NU:
+               fprintf(fp, " UL %s\n", bas_col_name(lp, j, buf1));
+               break;
+            default:
+               /* non-basic columns are on their lower bounds by
+                  default */
+               break;
+         }
+      }
+      fprintf(fp, "ENDATA\n");
+      if (fclose(fp) != 0)
+      {  glp_printf("lpx_write_bas: write error on '%s'\n", fname);
+         return 1;
+      }
       return 0;
 }
 
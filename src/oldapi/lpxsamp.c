@@ -6,6 +6,7 @@
 
 int main(void)
 {     LPX *lp;
+      LPXCPS cps;
       int ia[1+1000], ja[1+1000];
       double ar[1+1000], Z, x1, x2, x3;
 s1:   lp = lpx_create_prob();
@@ -38,7 +39,8 @@ s27:  ia[7] = 3, ja[7] = 2, ar[7] =  2.0; /* a[3,2] =  2 */
 s28:  ia[8] = 2, ja[8] = 3, ar[8] =  5.0; /* a[2,3] =  5 */
 s29:  ia[9] = 3, ja[9] = 3, ar[9] =  6.0; /* a[3,3] =  6 */
 s30:  lpx_load_matrix(lp, 9, ia, ja, ar);
-s31:  lpx_simplex(lp);
+      lpx_reset_parms(&cps);
+s31:  lpx_simplex(lp, &cps);
 s32:  Z = lpx_get_obj_val(lp);
 s33:  x1 = lpx_get_col_prim(lp, 1);
 s34:  x2 = lpx_get_col_prim(lp, 2);
@@ -0,0 +1,437 @@
+(**
+  * Small behavioral checks of the API.
+  *)
+
+open Glpk
+
+let failures = ref 0
+
+let check name b =
+  if not b then
+    (
+      incr failures;
+      Printf.printf "FAILED: %s\n%!" name
+    )
+
+let close x y = abs_float (x -. y) <= 1e-6 *. (1. +. abs_float y)
+
+(* Maximize 3 x0 + 5 x1 with x0 + x1 <= 4, x0 + 3 x1 <= 6 and x >= 0, whose
+   optimum is 13 at (3, 1). *)
+let small_problem () =
+  let lp = make_problem Maximize [|3.; 5.|] [|[|1.; 1.|]; [|1.; 3.|]|] [|-.infinity, 4.; -.infinity, 6.|] [|0., infinity; 0., infinity|] in
+    set_message_level lp 0;
+    lp
+
+(* An integer knapsack problem (see tests/knapsack), whose optimum is 165. *)
+let small_mip () =
+  let lp = make_problem Maximize [|3.; 5.; 7.|] [|[|12.; 3.; 9.|]|] [|-.infinity, 100.|] (Array.make 3 (0., infinity)) in
+    set_message_level lp 0;
+    set_class lp Mixed_integer_prog;
+    for i = 0 to 2 do set_col_kind lp i Integer_var done;
+    lp
+
+let int32_vector a = Bigarray.Array1.of_array Bigarray.int32 Bigarray.c_layout (Array.map Int32.of_int a)
+
+let float_vector a = Bigarray.Array1.of_array Bigarray.float64 Bigarray.c_layout a
+
+let int8_vector a = Bigarray.Array1.of_array Bigarray.int8_unsigned Bigarray.c_layout a
+
+(* The statuses of the rows and columns of small_problem. *)
+let basis lp =
+  let rows = Bigarray.Array1.create Bigarray.int8_unsigned Bigarray.c_layout 2 in
+  let cols = Bigarray.Array1.create Bigarray.int8_unsigned Bigarray.c_layout 2 in
+    get_basis lp rows cols;
+    rows, cols
+
+(* The constraint matrix of small_problem, with no matrix loaded. *)
+let empty_problem () =
+  let lp = small_problem () in
+    load_matrix lp [|[|0.; 0.|]; [|0.; 0.|]|];
+    lp
+
+let test_sparse_bigarray () =
+  let lp = empty_problem () in
+  let rows = int32_vector [|0; 0; 1; 1|] in
+  let cols = int32_vector [|0; 1; 0; 1|] in
+    load_sparse_matrix_bigarray lp rows cols (float_vector [|1.; 1.; 1.; 3.|]);
+    simplex lp;
+    check "load_sparse_matrix_bigarray" (close (get_obj_val lp) 13.);
+    check "load_sparse_matrix_bigarray keeps the indexes" (rows = int32_vector [|0; 0; 1; 1|] && cols = int32_vector [|0; 1; 0; 1|]);
+    check "load_sparse_matrix_bigarray bounds"
+      (try load_sparse_matrix_bigarray lp (int32_vector [|2|]) (int32_vector [|0|]) (float_vector [|1.|]); false with Invalid_argument _ -> true);
+    check "load_sparse_matrix_bigarray repeated element"
+      (try load_sparse_matrix_bigarray lp (int32_vector [|1; 0; 1|]) (int32_vector [|0; 1; 0|]) (float_vector [|1.; 1.; 1.|]); false with Invalid_argument _ -> true);
+    simplex lp;
+    check "load_sparse_matrix_bigarray keeps the matrix on errors" (close (get_obj_val lp) 13.)
+
+let test_compressed () =
+  let lp = empty_problem () in
+  (* Unused elements around the matrix. *)
+  let ptr = int32_vector [|1; 3; 5|] in
+  let ind = int32_vector [|7; 0; 1; 0; 1; 7|] in
+    load_csr_matrix lp ptr ind (float_vector [|0.; 1.; 1.; 1.; 3.; 0.|]);
+    simplex lp;
+    check "load_csr_matrix" (close (get_obj_val lp) 13.);
+    check "load_csr_matrix keeps the indexes" (ind = int32_vector [|7; 0; 1; 0; 1; 7|]);
+    let lp = empty_problem () in
+      load_csc_matrix lp (int32_vector [|0; 2; 4|]) (int32_vector [|0; 1; 0; 1|]) (float_vector [|1.; 1.; 1.; 3.|]);
+      simplex lp;
+      check "load_csc_matrix" (close (get_obj_val lp) 13.);
+      check "load_csc_matrix repeated index"
+        (try load_csc_matrix lp (int32_vector [|0; 2; 4|]) (int32_vector [|0; 0; 0; 1|]) (float_vector [|1.; 1.; 1.; 3.|]); false with Invalid_argument _ -> true);
+      simplex lp;
+      check "load_csc_matrix keeps the matrix on errors" (close (get_obj_val lp) 13.)
+
+let test_values () =
+  let lp = small_problem () in
+    simplex lp;
+    check "get_col_primals" (get_col_primals lp = [|get_col_primal lp 0; get_col_primal lp 1|]);
+    check "get_row_primals" (get_row_primals lp = [|get_row_primal lp 0; get_row_primal lp 1|]);
+    check "get_row_duals" (get_row_duals lp = [|get_row_dual lp 0; get_row_dual lp 1|]);
+    check "column primal values" (close (get_col_primals lp).(0) 3. && close (get_col_primals lp).(1) 1.);
+    let a = float_vector [|0.; 0.; 0.|] in
+      get_values_bigarray lp Row_primals a;
+      check "get_values_bigarray" (close a.{0} 4. && close a.{1} 6. && a.{2} = 0.);
+      check "get_values bounds"
+        (try get_values lp Col_primals [|0.|]; false with Invalid_argument _ -> true);
+      let mip = small_mip () in
+        simplex mip;
+        branch_and_bound mip;
+        check "MIP row primals" (close (get_row_primals mip).(0) (get_row_primals ~solution:Mip_solution mip).(0));
+        check "basic row primals" ((get_row_primals ~solution:Basic_solution mip).(0) = get_row_primal mip 0)
+
+let test_copy () =
+  let lp = small_problem () in
+    set_col_name lp 1 "y";
+    simplex lp;
+    let lp' = copy_problem lp in
+    let anonymous = copy_problem ~names:false lp in
+      set_row_bounds lp' 0 Upper_bounded_var 0. 5.;
+      reoptimize lp';
+      check "copy_problem" (close (get_obj_val lp') 16. && close (get_obj_val lp) 13.);
+      let words lp = List.concat (List.map (String.split_on_char ' ') (String.split_on_char '\n' (write_string Free_mps_format lp))) in
+        check "copy_problem names" (get_col_name lp' 1 = "y" && not (List.mem "y" (words anonymous)))
+
+let test_modify () =
+  let lp = small_problem () in
+  let invalid f = try f (); false with Invalid_argument _ -> true in
+    simplex lp;
+    check "set_mat_row repeated index" (invalid (fun () -> set_mat_row lp 0 [|1, 1.; 1, 2.|]));
+    check "set_mat_col bounds" (invalid (fun () -> set_mat_col lp 0 [|2, 1.|]));
+    check "del_rows repeated index" (invalid (fun () -> del_rows lp [|1; 1|]));
+    check "del_columns bounds" (invalid (fun () -> del_columns lp [|-1|]));
+    (* x1 <= 2 instead of x0 + 3 x1 <= 6: the optimum is 16 at (2, 2). *)
+    set_mat_row lp 1 [|1, 1.|];
+    set_row_bounds lp 1 Upper_bounded_var 0. 2.;
+    reoptimize lp;
+    check "reoptimize" (close (get_obj_val lp) 16.);
+    del_rows lp [|1|];
+    check "del_rows" (get_num_rows lp = 1);
+    reoptimize lp;
+    check "reoptimize after del_rows" (close (get_obj_val lp) 20.)
+
+let test_scenarios () =
+  let lp = small_problem () in
+  let row_upper = Bigarray.Array2.of_array Bigarray.float64 Bigarray.c_layout [|[|4.; 6.|]; [|5.; 6.|]; [|-1.; 6.|]|] in
+  let col_primals = Bigarray.Array2.create Bigarray.float64 Bigarray.c_layout 3 2 in
+  let objectives = float_vector [|0.; 0.; 0.|] in
+    simplex lp;
+    solve_scenarios ~row_upper ~col_primals lp objectives;
+    check "solve_scenarios" (close objectives.{0} 13. && close objectives.{1} 16.);
+    check "solve_scenarios primal values" (close col_primals.{1, 0} 4.5 && close col_primals.{1, 1} 0.5);
+    check "infeasible scenario" (Float.is_nan objectives.{2});
+    simplex lp;
+    check "solve_scenarios restores the bounds" (close (get_obj_val lp) 13.)
+
+let test_ranges () =
+  let lp = small_problem () in
+  let lo = float_vector [|0.; 0.|] in
+  let hi = float_vector [|0.; 0.|] in
+    check "ranges need an optimal solution" (try bound_ranges lp Rows lo hi; false with Failure _ -> true);
+    simplex lp;
+    (* The basis stays optimal for 2 <= x0 + x1 <= 6 and 5/3 <= c0 <= 5. *)
+    bound_ranges lp Rows lo hi;
+    check "bound_ranges" (close lo.{0} 2. && close hi.{0} 6.);
+    cost_ranges lp Columns lo hi;
+    check "cost_ranges" (close lo.{0} (5. /. 3.) && close hi.{0} 5.);
+    check "ranges out of bounds" (try cost_ranges ~first:1 lp Columns lo hi; false with Invalid_argument _ -> true)
+
+let test_tableau () =
+  let lp = small_problem () in
+  let ind = int32_vector [|0; 0|] in
+  let vals = float_vector [|0.; 0.|] in
+  let coef k =
+    let c = ref 0. in
+      for i = 0 to 1 do if Int32.to_int ind.{i} = k then c := vals.{i} done;
+      !c
+  in
+    simplex lp;
+    (* Both rows are active, so that x0 = (3 r0 - r1) / 2 in the optimal basis. *)
+    let len = eval_tab_row lp 2 ind vals in
+      check "eval_tab_row" (len = 2 && close (coef 0) 1.5 && close (coef 1) (-0.5));
+      check "eval_tab_row of a non-basic variable" (try ignore (eval_tab_row lp 0 ind vals); false with Invalid_argument _ -> true);
+      let len = eval_tab_col lp 0 ind vals in
+        check "eval_tab_col" (len = 2 && close (coef 2) 1.5 && close (coef 3) (-0.5));
+        check "prim_ratio_test" (prim_ratio_test lp len ind vals true 1e-9 <> None);
+        check "prim_ratio_test keeps the indexes" (close (coef 2) 1.5 && close (coef 3) (-0.5));
+        ind.{0} <- 0l;
+        ind.{1} <- 0l;
+        check "transform_row repeated index" (try ignore (transform_row lp 2 ind vals); false with Invalid_argument _ -> true)
+
+let test_kkt () =
+  let lp = small_problem () in
+    simplex lp;
+    let kkt = check_kkt lp in
+      check "check_kkt primal" (kkt.primal_equalities.quality = High_quality && kkt.primal_bounds.quality = High_quality);
+      check "check_kkt dual" (kkt.dual_equalities <> None && kkt.dual_bounds <> None);
+      let mip = small_mip () in
+        simplex mip;
+        branch_and_bound mip;
+        check "check_kkt of a MIP solution" ((check_kkt mip).dual_bounds = None)
+
+let test_mip_options () =
+  let lp = small_mip () in
+    set_cuts lp [Gomory_cuts; Mir_cuts];
+    check "get_cuts" (List.sort compare (get_cuts lp) = [Gomory_cuts; Mir_cuts]);
+    set_mip_gap lp 0.01;
+    check "get_mip_gap" (get_mip_gap lp = 0.01);
+    set_mip_gap lp 0.;
+    use_binarization lp true;
+    branch_and_bound_opt lp;
+    check "branch_and_bound_opt with cuts" (close (get_obj_val lp) 165.);
+    let lp = small_mip () in
+      branch_and_bound_with_params lp { default_mip_params with gomory_cuts = true; mip_presolve = true; mip_gap = 0. };
+      check "branch_and_bound_with_params" (close (get_obj_val lp) 165.)
+
+let test_cancel () =
+  let lp = small_problem () in
+  let token = new_cancel_token () in
+    simplex_with_params ~cancel:token lp default_simplex_params;
+    check "simplex with a token" (close (get_obj_val lp) 13.);
+    cancel token;
+    check "token is cancelled" (is_cancelled token);
+    check "cancelled simplex"
+      (try simplex_with_params ~cancel:token (small_problem ()) default_simplex_params; false with Cancelled -> true);
+    check "cancelled branch and bound"
+      (try
+         let lp = small_mip () in
+           simplex lp;
+           branch_and_bound_with_params ~cancel:token lp default_mip_params;
+           false
+       with Cancelled -> true)
+
+let test_progress () =
+  let lp = small_mip () in
+  let progress = new_progress ~interval:0. () in
+    simplex lp;
+    branch_and_bound_with_params ~progress lp default_mip_params;
+    check "mip solution" (close (get_obj_val lp) 165.);
+    let samples = poll_progress progress in
+      check "progress samples" (Array.length samples > 0);
+      check "progress is polled once" (poll_progress progress = [||]);
+      let last = samples.(Array.length samples - 1) in
+        check "last progress sample" (close last.incumbent 165.)
+
+let test_mps () =
+  let lp = small_problem () in
+  let fname = Filename.temp_file "glpk" ".mps" in
+  let solve lp =
+    set_message_level lp 0;
+    simplex lp;
+    get_obj_val lp
+  in
+    set_col_name lp 1 "y";
+    List.iter
+      (fun free ->
+         write_mps ~free lp fname;
+         let lp' = read_mps ~free fname in
+           check "read_mps names" (get_col_name lp' 1 = "y");
+           check "read_mps" (close (solve lp') 13.)
+      ) [false; true];
+    Sys.remove fname;
+    check "read_mps missing file" (try ignore (read_mps fname); false with Failure _ -> true)
+
+let test_strings () =
+  let lp = small_problem () in
+    List.iter
+      (fun format ->
+         let s = write_string format lp in
+         let lp' = read_string format s in
+           set_message_level lp' 0;
+           simplex lp';
+           check "read_string" (close (get_obj_val lp') 13.)
+      ) [Cplex_lp_format; Fixed_mps_format; Free_mps_format];
+    let s = write_string Free_mps_format lp in
+    let a = Bigarray.Array1.create Bigarray.int8_unsigned Bigarray.c_layout (String.length s) in
+      String.iteri (fun i c -> a.{i} <- Char.code c) s;
+      let lp' = read_bigarray Free_mps_format a in
+        check "read_bigarray" (get_num_rows lp' = 2 && get_num_cols lp' = 2);
+        check "read_string invalid data" (try ignore (read_string Cplex_lp_format "maximize"); false with Failure _ -> true)
+
+let test_marshal () =
+  let lp = small_problem () in
+    set_row_name lp 0 "cap";
+    set_col_name lp 1 "y";
+    let lp' : lp = Marshal.from_string (Marshal.to_string lp []) 0 in
+      check "marshaled names" (get_row_name lp' 0 = "cap" && get_col_name lp' 1 = "y");
+      simplex lp';
+      check "marshaled problem" (close (get_obj_val lp') 13.)
+
+let test_delete () =
+  let deleted lp = try ignore (get_num_rows lp); false with Invalid_argument _ -> true in
+  let lp = small_problem () in
+    check "memory_usage" (memory_usage lp > 0);
+    delete_problem lp;
+    check "delete_problem" (deleted lp);
+    check "memory_usage of a deleted problem" (try ignore (memory_usage lp); false with Invalid_argument _ -> true);
+    delete_problem lp;
+    let lp' : lp = Marshal.from_string (Marshal.to_string lp []) 0 in
+      check "marshaled deleted problem" (deleted lp');
+      let lp = small_problem () in
+        check "with_problem" (close (with_problem lp (fun lp -> simplex lp; get_obj_val lp)) 13.);
+        check "with_problem deletes" (deleted lp);
+        let lp = small_problem () in
+          (try with_problem lp (fun _ -> failwith "f") with Failure _ -> ());
+          check "with_problem deletes on exceptions" (deleted lp)
+
+let test_binary () =
+  let lp = small_problem () in
+  let fname = Filename.temp_file "glpk" ".bin" in
+    set_col_name lp 1 "y";
+    save_binary lp fname;
+    let lp' = load_binary fname in
+      check "binary names" (get_col_name lp' 1 = "y");
+      simplex lp';
+      check "binary problem" (close (get_obj_val lp') 13.);
+      (* Corrupt the last character of the name of the last column. *)
+      let ic = open_in_bin fname in
+      let s = Bytes.of_string (really_input_string ic (in_channel_length ic)) in
+        close_in ic;
+        Bytes.set s (Bytes.length s - 1) '\001';
+        let oc = open_out_bin fname in
+          output_bytes oc s;
+          close_out oc;
+          check "binary invalid name" (try ignore (load_binary fname); false with Failure _ -> true);
+          Sys.remove fname
+
+let test_set_basis () =
+  let lp = small_problem () in
+    simplex lp;
+    let rows, cols = basis lp in
+    let lp' = small_problem () in
+      set_basis lp' rows cols;
+      simplex lp';
+      check "set_basis" (close (get_obj_val lp') 13. && get_simplex_iteration_count lp' = 0);
+      rows.{0} <- 6;
+      check "set_basis invalid status" (try set_basis lp' rows cols; false with Invalid_argument _ -> true);
+      check "get_basis length" (try get_basis lp' rows (Bigarray.Array1.create Bigarray.int8_unsigned Bigarray.c_layout 1); false with Invalid_argument _ -> true)
+
+let test_build_basis () =
+  List.iter
+    (fun b ->
+       let lp = small_problem () in
+         build_basis lp b;
+         simplex lp;
+         check "build_basis" (close (get_obj_val lp) 13.);
+         let lp = small_problem () in
+           simplex_with_params ~basis:b lp default_simplex_params;
+           check "simplex_with_params ~basis" (close (get_obj_val lp) 13.)
+    ) [Standard_basis; Advanced_basis; Bixby_basis];
+  let lp = small_problem () in
+    build_basis lp Standard_basis;
+    check "standard basis" (basis lp = (int8_vector [|1; 1|], int8_vector [|2; 2|]))
+
+let test_basis () =
+  let lp = small_problem () in
+  let fname = Filename.temp_file "glpk" ".bas" in
+  let write_file s =
+    let oc = open_out_bin fname in
+      output_string oc s;
+      close_out oc
+  in
+    set_col_name lp 0 (String.make 255 'x');
+    simplex lp;
+    write_basis lp fname;
+    let lp' = copy_problem lp in
+      build_basis lp' Standard_basis;
+      read_basis lp' fname;
+      check "read_basis" (basis lp' = basis lp);
+      build_basis lp' Standard_basis;
+      let std = basis lp' in
+        write_file "NAME\n XU C2 R1\n XL C2 R3\nENDATA\n";
+        check "read_basis invalid row" (try read_basis lp' fname; false with Failure _ -> true);
+        check "read_basis keeps the basis" (basis lp' = std);
+        write_file ("NAME\n XU " ^ String.make 2000 'x' ^ " R1\nENDATA\n");
+        check "read_basis long name" (try read_basis lp' fname; false with Failure _ -> true);
+        Sys.remove fname
+
+let test_mathprog () =
+  let model = mathprog_model (Mathprog_string "param c; var x >= 0; maximize z: c * x; s.t. cap: x <= 4; end;") in
+  let build c =
+    let lp = build_mathprog ~data:[Mathprog_string (Printf.sprintf "data; param c := %g; end;" c)] model in
+      set_message_level lp 0;
+      simplex lp;
+      get_obj_val lp
+  in
+    check "mathprog build" (close (build 2.) 8.);
+    check "mathprog rebuild" (close (build 3.) 12.);
+    check "mathprog syntax error"
+      (try ignore (build_mathprog (mathprog_model (Mathprog_string "var x >= ;"))); false with Failure _ -> true)
+
+let test_log () =
+  let log = new_log () in
+  let lp = small_problem () in
+    set_message_level lp 3;
+    with_log log (fun () -> simplex lp);
+    check "log captures the output" (String.length (read_log log) > 0);
+    check "log is read once" (read_log log = "");
+    let small = new_log ~capacity:16 () in
+    let inner = new_log () in
+      with_log small
+        (fun () ->
+           with_log inner (fun () -> simplex (copy_problem lp));
+           simplex (copy_problem lp));
+      check "nested logs" (String.length (read_log inner) > 0);
+      check "previous log is restored" (String.length (read_log small) > 0);
+      check "log keeps the end" (String.length (read_log small) <= 16);
+      (* The log must stay valid while installed, even if unreachable. *)
+      with_log (new_log ()) (fun () -> Gc.full_major (); simplex (copy_problem lp));
+      (* free_env uninstalls the log (and deletes lp). *)
+      let log = new_log () in
+        with_log log
+          (fun () ->
+             free_env ();
+             let lp = small_problem () in
+               set_message_level lp 3;
+               simplex lp);
+        check "free_env uninstalls the log" (read_log log = "")
+
+let () =
+  test_sparse_bigarray ();
+  test_compressed ();
+  test_values ();
+  test_copy ();
+  test_modify ();
+  test_scenarios ();
+  test_ranges ();
+  test_tableau ();
+  test_kkt ();
+  test_mps ();
+  test_strings ();
+  test_mip_options ();
+  test_cancel ();
+  test_progress ();
+  test_marshal ();
+  test_delete ();
+  test_binary ();
+  test_set_basis ();
+  test_build_basis ();
+  test_basis ();
+  test_mathprog ();
+  test_log ();
+  if !failures > 0 then
+    (
+      Printf.printf "%d checks failed.\n%!" !failures;
+      exit 1
+    );
+  print_endline "All checks passed."
@@ -0,0 +1,61 @@
+(**
+  * Effect of the MIP presolver, cutting planes and binarization on knapsack
+  * problems similar to the ones of tests/knapsack.
+  *)
+
+open Glpk
+
+(* Knapsack problem with several constraints where each item can be taken up to
+   [copies] times. *)
+let make_kp z c b copies =
+  let n = Array.length z in
+  let bbounds = Array.map (fun b -> 0., b) b in
+  let xbounds = Array.make n (0., float copies) in
+  let lp = make_problem Maximize z c bbounds xbounds in
+    set_class lp Mixed_integer_prog;
+    for i = 0 to n - 1 do
+      set_col_kind lp i Integer_var
+    done;
+    set_message_level lp 0;
+    lp
+
+let instances =
+  Random.init 42;
+  Array.init 5
+    (fun _ ->
+       let n = 35 and m = 4 in
+       let z = Array.init n (fun _ -> float (10 + Random.int 90)) in
+       let c = Array.init m (fun _ -> Array.init n (fun _ -> float (5 + Random.int 95))) in
+       let b = Array.init m (fun i -> 0.6 *. Array.fold_left (+.) 0. c.(i)) in
+         z, c, b)
+
+let configs =
+  [
+    "branch and bound",
+    (fun lp -> simplex lp; branch_and_bound lp);
+    "presolve",
+    branch_and_bound_opt;
+    "presolve + cuts",
+    (fun lp -> set_cuts lp [Cover_cuts; Clique_cuts; Gomory_cuts; Mir_cuts]; branch_and_bound_opt lp);
+    "presolve + cuts + binarization",
+    (fun lp -> set_cuts lp [Cover_cuts; Clique_cuts; Gomory_cuts; Mir_cuts]; use_binarization lp true; branch_and_bound_opt lp);
+    "presolve + cuts + 1% gap",
+    (fun lp -> set_cuts lp [Cover_cuts; Clique_cuts; Gomory_cuts; Mir_cuts]; set_mip_gap lp 0.01; branch_and_bound_opt lp);
+  ]
+
+let () =
+  List.iter
+    (fun (name, solve) ->
+       let t = Sys.time () in
+       let obj =
+         Array.map
+           (fun (z, c, b) ->
+              let lp = make_kp z c b 3 in
+                solve lp;
+                get_obj_val lp)
+           instances
+       in
+       let t = Sys.time () -. t in
+         Printf.printf "%-32s %8.3fs   objectives:%s\n%!" name t
+           (String.concat "" (Array.to_list (Array.map (Printf.sprintf " %g") obj))))
+    configs
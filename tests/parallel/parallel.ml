@@ -0,0 +1,59 @@
+(**
+  * Stress test: solve many problems concurrently in several threads.
+  *)
+
+open Glpk
+
+let threads = 8
+
+let problems = 400
+
+let errors = ref 0
+
+let errors_m = Mutex.create ()
+
+let error msg =
+  Mutex.lock errors_m;
+  incr errors;
+  Mutex.unlock errors_m;
+  prerr_endline msg
+
+(* Maximize sum c_i x_i with sum x_i <= k and 0 <= x_i <= 1, whose optimum is
+   the sum of the k largest c_i. *)
+let solve seed =
+  let n = 20 + seed mod 30 in
+  let k = 1 + seed mod 5 in
+  let c = Array.init n (fun i -> float ((i * 7919 + seed * 104729) mod 101)) in
+  let lp = make_problem Maximize c [|Array.make n 1.|] [|-.infinity, float k|] (Array.make n (0., 1.)) in
+    set_message_level lp 0;
+    simplex lp;
+    let sorted = Array.copy c in
+      Array.sort (fun x y -> compare y x) sorted;
+      let expected = ref 0. in
+        for i = 0 to k - 1 do
+          expected := !expected +. sorted.(i)
+        done;
+        if abs_float (get_obj_val lp -. !expected) > 1e-6 then
+          error (Printf.sprintf "Problem %d: got %g instead of %g." seed (get_obj_val lp) !expected)
+
+let worker t =
+  try
+    with_env
+      (fun () ->
+         for i = 0 to problems - 1 do
+           solve (t * problems + i);
+           (* Finalize problems, including the ones of other threads. *)
+           if i mod 50 = 0 then Gc.full_major ()
+         done)
+  with e -> error (Printexc.to_string e)
+
+let () =
+  let th = Array.init threads (Thread.create worker) in
+    Array.iter Thread.join th;
+    Gc.full_major ();
+    if !errors > 0 then
+      (
+        Printf.printf "%d errors.\n%!" !errors;
+        exit 1
+      );
+    Printf.printf "Solved %d problems in %d threads.\n%!" (threads * problems) threads
@@ -0,0 +1,87 @@
+(**
+  * Stress test: solve many problems concurrently in several domains (requires
+  * OCaml 5).
+  *)
+
+open Glpk
+
+let domains = max 2 (min 8 (Domain.recommended_domain_count ()))
+
+let problems = 400
+
+let errors = Atomic.make 0
+
+let error msg =
+  Atomic.incr errors;
+  prerr_endline msg
+
+(* Maximize sum c_i x_i with sum x_i <= k and 0 <= x_i <= 1, whose optimum is
+   the sum of the k largest c_i. *)
+let solve seed =
+  let n = 20 + seed mod 30 in
+  let k = 1 + seed mod 5 in
+  let c = Array.init n (fun i -> float ((i * 7919 + seed * 104729) mod 101)) in
+  let lp = make_problem Maximize c [|Array.make n 1.|] [|-.infinity, float k|] (Array.make n (0., 1.)) in
+    set_message_level lp 0;
+    simplex lp;
+    let sorted = Array.copy c in
+      Array.sort (fun x y -> compare y x) sorted;
+      let expected = ref 0. in
+        for i = 0 to k - 1 do
+          expected := !expected +. sorted.(i)
+        done;
+        if abs_float (get_obj_val lp -. !expected) > 1e-6 then
+          error (Printf.sprintf "Problem %d: got %g instead of %g." seed (get_obj_val lp) !expected);
+        lp
+
+let deleted lp =
+  try ignore (get_obj_val lp); false with Invalid_argument _ -> true
+
+let worker d () =
+  try
+    for i = 0 to problems - 1 do
+      ignore (solve (d * problems + i));
+      (* Finalize problems, including the ones of other domains. *)
+      if i mod 50 = 0 then Gc.full_major ()
+    done;
+    (* Problems are deleted along with the environment. *)
+    let lp = solve d in
+      free_env ();
+      if not (deleted lp) then error "Problem was not deleted by free_env.";
+      ignore (solve (d + 1))
+  with e -> error (Printexc.to_string e)
+
+(* Build the problems of solve, without solving them. *)
+let build seed () =
+  let n = 20 + seed mod 30 in
+  let k = 1 + seed mod 5 in
+  let c = Array.init n (fun i -> float ((i * 7919 + seed * 104729) mod 101)) in
+  let lp = make_problem Maximize c [|Array.make n 1.|] [|-.infinity, float k|] (Array.make n (0., 1.)) in
+    set_message_level lp 0;
+    lp
+
+let batch () =
+  let n = domains * problems in
+  let results = Glpk_batch.solve (Array.init n build) in
+    Array.iteri
+      (fun seed r ->
+         match r with
+         | Ok { Glpk_batch.status = Optimal; objective } ->
+           let lp = solve seed in
+             if abs_float (objective -. get_obj_val lp) > 1e-6 then
+               error (Printf.sprintf "Batch problem %d: got %g instead of %g." seed objective (get_obj_val lp))
+         | Ok _ -> error (Printf.sprintf "Batch problem %d is not optimal." seed)
+         | Error e -> error (Printexc.to_string e))
+      results
+
+let () =
+  let ds = Array.init domains (fun d -> Domain.spawn (worker d)) in
+    Array.iter Domain.join ds;
+    batch ();
+    Gc.full_major ();
+    if Atomic.get errors > 0 then
+      (
+        Printf.printf "%d errors.\n%!" (Atomic.get errors);
+        exit 1
+      );
+    Printf.printf "Solved %d problems in %d domains.\n%!" (domains * problems) domains
@@ -0,0 +1,69 @@
+(**
+  * Adding constraints one by one to a solved LP problem, as in a cutting-plane
+  * loop: incremental modifications followed by reoptimize compared to
+  * rebuilding and solving the problem from scratch.
+  *)
+
+open Glpk
+
+let n = 200
+let m = 50
+let cuts = 300
+
+let () = Random.init 42
+
+let z = Array.init n (fun _ -> float (10 + Random.int 90))
+
+let rows =
+  Array.init (m + cuts)
+    (fun _ -> Array.init n (fun _ -> if Random.int 4 = 0 then float (1 + Random.int 99) else 0.))
+
+let rhs = Array.map (fun r -> 0.3 *. Array.fold_left (+.) 0. r) rows
+
+let xbounds = Array.make n (0., 1.)
+
+let make k =
+  let c = Array.sub rows 0 k in
+  let b = Array.map (fun b -> -. infinity, b) (Array.sub rhs 0 k) in
+  let lp = make_problem Maximize z c b xbounds in
+    set_message_level lp 0;
+    lp
+
+let sparse r =
+  let l = ref [] in
+    for j = Array.length r - 1 downto 0 do
+      if r.(j) <> 0. then l := (j, r.(j)) :: !l
+    done;
+    Array.of_list !l
+
+let rebuild () =
+  let obj = ref 0. in
+    for k = m to m + cuts do
+      let lp = make k in
+        simplex lp;
+        obj := get_obj_val lp
+    done;
+    !obj
+
+let incremental () =
+  let lp = make m in
+    simplex lp;
+    for k = m to m + cuts - 1 do
+      add_rows lp 1;
+      set_mat_row lp k (sparse rows.(k));
+      set_row_bounds lp k Upper_bounded_var 0. rhs.(k);
+      reoptimize lp
+    done;
+    get_obj_val lp
+
+let () =
+  List.iter
+    (fun (name, f) ->
+       let t = Sys.time () in
+       let obj = f () in
+       let t = Sys.time () -. t in
+         Printf.printf "%-12s %8.3fs   objective: %g\n%!" name t obj)
+    [
+      "rebuild", rebuild;
+      "incremental", incremental;
+    ]